@@ -8,10 +8,15 @@
     - Show exception handling for remove() and invalid iterator operations.
     - Illustrate iterator snapshot behavior when modifying the container.
     - Use range-based for loops (Order) to iterate in insertion order.
+    - `main_demo --train` skips the demo and runs trainingWorkload() instead: the
+      representative run that `make pgo` profiles before rebuilding the demo.
 */
 
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 #include "MyContainer.hpp"
 
 using namespace container;
@@ -222,7 +227,74 @@ void demoDoubleContainer() {
     std::cout << "-----------------------------------\n\n";
 }
 
-int main() {
+/*
+    Training run for profile-guided builds (make pgo): containers of realistic size
+    traversed in all six orders, with the operations that invalidate the cached
+    permutation in between, plus sorted runs, reductions and text round trips.
+*/
+long trainingWorkload() {
+    long checksum = 0;
+    auto walkAll = [&checksum](const auto& cont) {
+        auto walk = [&checksum](auto it, auto end) {
+            for (; it != end; ++it) {
+                checksum += static_cast<long>(*it);
+            }
+        };
+        walk(cont.beginOrder(), cont.endOrder());
+        walk(cont.beginAscendingOrder(), cont.endAscendingOrder());
+        walk(cont.beginDescendingOrder(), cont.endDescendingOrder());
+        walk(cont.beginReverseOrder(), cont.endReverseOrder());
+        walk(cont.beginSideCrossOrder(), cont.endSideCrossOrder());
+        walk(cont.beginMiddleOutOrder(), cont.endMiddleOutOrder());
+    };
+
+    for (size_t n : {size_t(12), size_t(60), size_t(5000), size_t(200000)}) {
+        MyContainer<int> ints;
+        MyContainer<double> doubles;
+        for (size_t i = 0; i < n; ++i) {
+            ints.add(static_cast<int>((i * 2654435761u) % 100003));
+            doubles.add(static_cast<double>((i * 40503u) % 9973) / 3.0);
+        }
+        walkAll(ints);
+        walkAll(doubles);
+
+        // Mutations drop the cached permutation, so the sorted orders are rebuilt
+        ints.remove(ints.max());
+        ints.add(-1);
+        walkAll(ints);
+        checksum += static_cast<long>(ints.sum()) + ints.min() + static_cast<long>(doubles.mean());
+
+        std::ostringstream text;
+        text << ints;
+        checksum += static_cast<long>(MyContainer<int>::parse(text.str()).size());
+    }
+
+    MyContainer<int> runs;
+    for (int r = 0; r < 16; ++r) {
+        std::vector<int> run(10000);
+        for (int i = 0; i < 10000; ++i) {
+            run[static_cast<size_t>(i)] = i * 16 + r;
+        }
+        runs.addSortedRun(run);
+    }
+    walkAll(runs);
+
+    MyContainer<std::string> words;
+    for (int i = 0; i < 2000; ++i) {
+        words.add("w" + std::to_string((i * 7919) % 2003));
+    }
+    for (auto it = words.beginSideCrossOrder(); it != words.endSideCrossOrder(); ++it) {
+        checksum += static_cast<long>((*it).size());
+    }
+    return checksum;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--train") == 0) {
+        std::cout << "Training checksum: " << trainingWorkload() << "\n";
+        return 0;
+    }
+
     std::cout << "*** MyContainer<T> Comprehensive Demo ***\n\n";
 
     // Integer container demonstration
@@ -0,0 +1,198 @@
+// eitan.derdiger@gmail.com
+
+#ifndef BENCHUTIL_HPP
+#define BENCHUTIL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+  BenchUtil.hpp holds the small timing helpers shared by the benchmark programs
+  under bench/.
+
+    - bench::bestOf(reps, fn): runs fn reps times and returns the fastest run in seconds.
+    - bench::doNotOptimize(value): keeps a computed value alive so the optimizer
+      cannot drop the measured work.
+    - bench::PerfCounters: Linux hardware counters (cycles, last-level cache read misses,
+      branch misses) of the calling thread, user space only, read with perf_event_open.
+      Each event that cannot be opened (no PMU in a VM, perf_event_paranoid > 2, not
+      Linux) is reported as missing instead of failing the benchmark; whyUnavailable()
+      says why.
+    - bench::bestOfCounted(reps, counters, fn): bestOf() that also returns the counter
+      deltas of the fastest run (none when counters is null).
+    - bench::hasFlag(argc, argv, "--perf"): the opt-in switch for counter output.
+*/
+
+namespace bench {
+
+template<typename Fn>
+double bestOf(int reps, Fn&& fn) {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+template<typename V>
+inline void doNotOptimize(const V& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline bool hasFlag(int argc, char** argv, const char* flag) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0) return true;
+    }
+    return false;
+}
+
+// Counter deltas over one measured region; a missing event reads as -1
+struct PerfSample {
+    static constexpr int EventCount = 3;
+    enum Event { Cycles, CacheMisses, BranchMisses };
+
+    int64_t values[EventCount] = {-1, -1, -1};
+
+    bool has(Event e) const noexcept { return values[e] >= 0; }
+
+    // Counter value per element, or -1 when the event is missing
+    double per(Event e, double elements) const noexcept {
+        return has(e) ? static_cast<double>(values[e]) / elements : -1.0;
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+#ifdef __linux__
+        const uint32_t types[PerfSample::EventCount] = {PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                                        PERF_TYPE_HARDWARE};
+        const uint64_t configs[PerfSample::EventCount] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES};
+        for (int e = 0; e < PerfSample::EventCount; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;  // Allowed up to perf_event_paranoid == 2
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[e] < 0 && error_ == 0) {
+                error_ = errno;
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    // True when at least one event could be opened
+    bool available() const noexcept {
+        return std::any_of(fds_, fds_ + PerfSample::EventCount, [](int fd) { return fd >= 0; });
+    }
+
+    // The reason the first missing event could not be opened, or "" when none is missing
+    const char* whyUnavailable() const noexcept {
+#ifdef __linux__
+        return error_ ? std::strerror(error_) : "";
+#else
+        return "perf_event_open is Linux only";
+#endif
+    }
+
+    void start() noexcept {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Stops counting and returns the counts since start(), scaled up if the kernel
+    // multiplexed an event (ran it for only part of the region)
+    PerfSample stop() noexcept {
+        PerfSample sample;
+#ifdef __linux__
+        for (int e = 0; e < PerfSample::EventCount; ++e) {
+            if (fds_[e] >= 0) {
+                ioctl(fds_[e], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (int e = 0; e < PerfSample::EventCount; ++e) {
+            uint64_t data[3];  // value, time enabled, time running
+            if (fds_[e] < 0 || read(fds_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+                continue;
+            }
+            if (data[2] == 0) {
+                continue;  // Enabled but never scheduled: no estimate
+            }
+            double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            sample.values[e] = static_cast<int64_t>(static_cast<double>(data[0]) * scale);
+        }
+#endif
+        return sample;
+    }
+
+private:
+    int fds_[PerfSample::EventCount] = {-1, -1, -1};
+    int error_ = 0;
+};
+
+struct Measurement {
+    double seconds = std::numeric_limits<double>::max();
+    PerfSample counters;
+};
+
+template<typename Fn>
+Measurement bestOfCounted(int reps, PerfCounters* counters, Fn&& fn) {
+    Measurement best;
+    for (int r = 0; r < reps; ++r) {
+        if (counters) counters->start();
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        PerfSample sample = counters ? counters->stop() : PerfSample{};
+        if (elapsed.count() < best.seconds) {
+            best.seconds = elapsed.count();
+            best.counters = sample;
+        }
+    }
+    return best;
+}
+
+} // namespace bench
+
+#endif // BENCHUTIL_HPP
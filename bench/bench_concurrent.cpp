@@ -0,0 +1,64 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Measure multi-producer add() throughput from 1 to 64 threads.
+    - Compare ConcurrentMyContainer<int> against a MyContainer<int> guarded by one mutex.
+*/
+
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "ConcurrentMyContainer.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t TotalAdds = 4'000'000;
+
+// Runs body(threadIndex, addsPerThread) on the given number of threads.
+template<typename Body>
+void runProducers(size_t threads, Body body) {
+    std::vector<std::thread> pool;
+    size_t perThread = TotalAdds / threads;
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&body, t, perThread] { body(t, perThread); });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-8s %18s %18s\n", "threads", "mutex (Madds/s)", "sharded (Madds/s)");
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        double locked = bench::bestOf(3, [&] {
+            MyContainer<int> c;
+            std::mutex m;
+            runProducers(threads, [&](size_t t, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    std::lock_guard<std::mutex> lock(m);
+                    c.add(static_cast<int>(t + i));
+                }
+            });
+            bench::doNotOptimize(c.size());
+        });
+        double sharded = bench::bestOf(3, [&] {
+            ConcurrentMyContainer<int> c;
+            runProducers(threads, [&](size_t t, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    c.add(static_cast<int>(t + i));
+                }
+            });
+            bench::doNotOptimize(c.size());
+        });
+        std::printf("%-8zu %18.1f %18.1f\n", threads,
+                    TotalAdds / locked / 1e6, TotalAdds / sharded / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Time an AscendingOrder walk over 16M 64-bit integers (128 MB) held in memory by
+      MyContainer and on disk by ExternalContainer with budgets of 32 MiB, 4 MiB and 256 KiB.
+    - The smaller budgets produce more runs, so they show the cost of the extra merge
+      width and, at 256 KiB (fan-in 63), of a merge pass.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include "BenchUtil.hpp"
+#include "ExternalContainer.hpp"
+#include "MyContainer.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t Count = size_t(1) << 24;
+
+int64_t valueAt(size_t i) {
+    return static_cast<int64_t>((i * 2654435761u) % 1000000007u);
+}
+
+template<typename Container>
+void ascendingWalk(Container& c) {
+    int64_t sum = 0;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        sum += *it;
+    }
+    bench::doNotOptimize(sum);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-24s %8s %10s\n", "ascending walk", "runs", "time (s)");
+
+    double inMemory = bench::bestOf(1, [] {
+        MyContainer<int64_t> c;
+        c.reserve(Count);
+        for (size_t i = 0; i < Count; ++i) {
+            c.add(valueAt(i));
+        }
+        ascendingWalk(c);
+    });
+    std::printf("%-24s %8s %10.3f\n", "MyContainer (128 MB)", "-", inMemory);
+
+    for (size_t budget : {size_t(32) << 20, size_t(4) << 20, size_t(256) << 10}) {
+        size_t runs = (Count * sizeof(int64_t) + budget - 1) / budget;
+        double external = bench::bestOf(1, [&] {
+            ExternalContainer<int64_t> c(budget);
+            for (size_t i = 0; i < Count; ++i) {
+                c.add(valueAt(i));
+            }
+            ascendingWalk(c);
+        });
+        char label[32];
+        std::snprintf(label, sizeof(label), "External, %zu KiB", budget >> 10);
+        std::printf("%-24s %8zu %10.3f\n", label, runs, external);
+    }
+    return 0;
+}
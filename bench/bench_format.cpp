@@ -0,0 +1,105 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Dump 10M ints (and 2M doubles) to /dev/null: per-element stream insertion (the
+      previous operator<<) against the bulk to_chars formatter now behind operator<<,
+      and io::print() of AscendingOrder.
+    - Read the 10M-int dump back: an ad-hoc istream >> / add() loop against
+      MyContainer::parse() on a string_view and on a file stream, in MB/s.
+*/
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "BenchUtil.hpp"
+#include "MyContainer.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t Ints = 10000000;
+constexpr size_t Doubles = 2000000;
+
+// The previous operator<<: one formatted insertion per element and separator.
+template<typename T>
+void streamEach(std::ostream& os, const MyContainer<T>& c) {
+    os << "[";
+    bool separate = false;
+    auto end = c.endOrder();
+    for (auto it = c.beginOrder(); it != end; ++it) {
+        if (separate) os << ", ";
+        os << *it;
+        separate = true;
+    }
+    os << "]";
+}
+
+template<typename T>
+void run(const char* name, const MyContainer<T>& c) {
+    std::ofstream out("/dev/null");
+    double each = bench::bestOf(3, [&] { streamEach(out, c); out.flush(); });
+    double bulk = bench::bestOf(3, [&] { out << c; out.flush(); });
+    double ascending = bench::bestOf(3, [&] {
+        io::print(out, c.beginAscendingOrder(), c.endAscendingOrder());
+        out.flush();
+    });
+    std::printf("%-8s %14.3f %14.3f %18.3f\n", name, each, bulk, ascending);
+}
+
+// The ad-hoc loader: stream extraction and one add() per element.
+MyContainer<int> extractEach(const std::string& text) {
+    std::istringstream in(text);
+    MyContainer<int> c;
+    char sep = 0;
+    in >> sep;  // '['
+    int v = 0;
+    while (in >> v) {
+        c.add(v);
+        in >> sep;  // ',' or ']'
+    }
+    return c;
+}
+
+void runParse(const MyContainer<int>& ints) {
+    std::ostringstream os;
+    os << ints;
+    std::string text = os.str();
+    std::string path = (std::filesystem::temp_directory_path() / "bench_format.txt").string();
+    std::ofstream(path) << text;
+    double mb = static_cast<double>(text.size()) / 1e6;
+
+    double each = bench::bestOf(3, [&] { bench::doNotOptimize(extractEach(text).size()); });
+    double view = bench::bestOf(3, [&] { bench::doNotOptimize(MyContainer<int>::parse(text).size()); });
+    double file = bench::bestOf(3, [&] {
+        std::ifstream in(path, std::ios::binary);
+        bench::doNotOptimize(MyContainer<int>::parse(in).size());
+    });
+    std::printf("\n%-8s %14s %14s %18s\n", "parse", "istream >>", "string_view", "ifstream");
+    std::printf("%-8s %14.0f %14.0f %18.0f   (MB/s, %.0f MB)\n", "int", mb / each, mb / view, mb / file, mb);
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main() {
+    MyContainer<int> ints;
+    ints.reserve(Ints);
+    for (size_t i = 0; i < Ints; ++i) {
+        ints.add(static_cast<int>(i * 2654435761u));
+    }
+    MyContainer<double> doubles;
+    doubles.reserve(Doubles);
+    for (size_t i = 0; i < Doubles; ++i) {
+        doubles.add(static_cast<double>(i * 2654435761u % 1000003) / 7.0);
+    }
+
+    std::printf("%-8s %14s %14s %18s\n", "type", "per-element", "bulk <<", "print(ascending)");
+    run("int", ints);
+    run("double", doubles);
+    runParse(ints);
+    return 0;
+}
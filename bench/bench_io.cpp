@@ -0,0 +1,88 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Compare ways of restoring a saved container of 16M doubles (128 MB): reparsing
+      the operator<< text, io::load() of the binary format and io::openMapped().
+    - For the mapped container, also time the first full traversal, which is when
+      its pages are actually read, and the first AscendingOrder walk with and without
+      a permutation stored by io::save(c, path, true).
+*/
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "BenchUtil.hpp"
+#include "io/Serialization.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t Count = size_t(1) << 24;
+
+// Reads back the "[a, b, c]" text that operator<< writes.
+MyContainer<double> parseText(const std::string& path) {
+    std::ifstream in(path);
+    MyContainer<double> c;
+    c.reserve(Count);
+    char sep = 0;
+    in >> sep;  // '['
+    double v = 0;
+    while (in >> v) {
+        c.add(v);
+        in >> sep;  // ',' or ']'
+    }
+    return c;
+}
+
+} // namespace
+
+int main() {
+    auto dir = std::filesystem::temp_directory_path();
+    std::string textPath = (dir / "bench_io.txt").string();
+    std::string binPath = (dir / "bench_io.bin").string();
+    std::string sortedPath = (dir / "bench_io_sorted.bin").string();
+
+    MyContainer<double> c;
+    c.reserve(Count);
+    for (size_t i = 0; i < Count; ++i) {
+        c.add(static_cast<double>((i * 2654435761u) % 1000003) / 7.0);
+    }
+    {
+        std::ofstream out(textPath);
+        out.precision(17);
+        out << c;
+    }
+    io::save(c, binPath);
+    io::save(c, sortedPath, true);
+
+    double text = bench::bestOf(1, [&] { bench::doNotOptimize(parseText(textPath).size()); });
+    double binary = bench::bestOf(3, [&] { bench::doNotOptimize(io::load<double>(binPath).size()); });
+    double mapped = bench::bestOf(3, [&] { bench::doNotOptimize(io::openMapped<double>(binPath).size()); });
+    auto opened = io::openMapped<double>(binPath);
+    double firstWalk = bench::bestOf(1, [&] { bench::doNotOptimize(opened.sum()); });
+    auto ascendingWalk = [](const auto& cont) {
+        double sum = 0;
+        for (auto it = cont.beginAscendingOrder(); it != cont.endAscendingOrder(); ++it) {
+            sum += *it;
+        }
+        bench::doNotOptimize(sum);
+    };
+    double sortOnOpen = bench::bestOf(1, [&] { ascendingWalk(io::openMapped<double>(binPath)); });
+    double storedOrder = bench::bestOf(1, [&] { ascendingWalk(io::openMapped<double>(sortedPath)); });
+
+    std::printf("%-22s %10s\n", "restore", "time (s)");
+    std::printf("%-22s %10.4f\n", "text reparse", text);
+    std::printf("%-22s %10.4f\n", "binary load", binary);
+    std::printf("%-22s %10.4f\n", "mapped open", mapped);
+    std::printf("%-22s %10.4f\n", "mapped first sum()", firstWalk);
+    std::printf("%-22s %10.4f\n", "ascending, sort", sortOnOpen);
+    std::printf("%-22s %10.4f\n", "ascending, stored", storedOrder);
+
+    std::filesystem::remove(textPath);
+    std::filesystem::remove(binPath);
+    std::filesystem::remove(sortedPath);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Report the throughput (GB/s) of the vectorized find/count/remove kernels for
+      int32_t and float, next to the scalar std:: algorithms they replace.
+    - Report the minmax/sum reductions for int32_t, float and double against
+      std::minmax_element / std::accumulate.
+*/
+
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "simd/Kernels.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t N = 1 << 24;  // 64 MiB of 4-byte elements
+constexpr int Reps = 5;
+
+template<typename T>
+void run(const char* typeName) {
+    std::vector<T> data(N);
+    for (size_t i = 0; i < N; ++i) {
+        data[i] = static_cast<T>((i * 2654435761u) % 1000);
+    }
+    const T needle = static_cast<T>(7);
+    const T absent = static_cast<T>(5000);
+    const double gb = static_cast<double>(N * sizeof(T)) / 1e9;
+
+    auto report = [&](const char* op, double scalar, double vector) {
+        std::printf("%-6s %-8s %10.2f %10.2f %8.2fx\n", typeName, op, gb / scalar, gb / vector,
+                    scalar / vector);
+    };
+
+    report("find",
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(std::find(data.begin(), data.end(), absent)); }),
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(simd::find(data.data(), N, absent)); }));
+    report("count",
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(std::count(data.begin(), data.end(), needle)); }),
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(simd::count(data.data(), N, needle)); }));
+
+    // remove works on a fresh copy each time; the copy is timed separately and subtracted
+    std::vector<T> work(N);
+    double copyTime = bench::bestOf(Reps, [&] {
+        std::copy(data.begin(), data.end(), work.begin());
+        bench::doNotOptimize(work.data());
+    });
+    double scalarRemove = bench::bestOf(Reps, [&] {
+        std::copy(data.begin(), data.end(), work.begin());
+        bench::doNotOptimize(std::remove(work.begin(), work.end(), needle));
+    }) - copyTime;
+    double vectorRemove = bench::bestOf(Reps, [&] {
+        std::copy(data.begin(), data.end(), work.begin());
+        bench::doNotOptimize(simd::removeAll(work.data(), N, needle));
+    }) - copyTime;
+    report("remove", scalarRemove, vectorRemove);
+}
+
+template<typename T>
+void runReductions(const char* typeName) {
+    std::vector<T> data(N);
+    for (size_t i = 0; i < N; ++i) {
+        data[i] = static_cast<T>((i * 2654435761u) % 1000);
+    }
+    const double gb = static_cast<double>(N * sizeof(T)) / 1e9;
+
+    auto report = [&](const char* op, double scalar, double vector) {
+        std::printf("%-6s %-8s %10.2f %10.2f %8.2fx\n", typeName, op, gb / scalar, gb / vector,
+                    scalar / vector);
+    };
+
+    report("minmax",
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(std::minmax_element(data.begin(), data.end())); }),
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(simd::minmax(data.data(), N)); }));
+    report("sum",
+           bench::bestOf(Reps, [&] {
+               bench::doNotOptimize(std::accumulate(data.begin(), data.end(), simd::SumType<T>(0)));
+           }),
+           bench::bestOf(Reps, [&] { bench::doNotOptimize(simd::sum(data.data(), N)); }));
+}
+
+} // namespace
+
+int main() {
+    std::printf("kernel isa: %s\n", simd::activeIsa());
+    std::printf("%-6s %-8s %10s %10s %9s\n", "type", "op", "std GB/s", "simd GB/s", "speedup");
+    run<int32_t>("int32");
+    run<float>("float");
+    runReductions<int32_t>("int32");
+    runReductions<float>("float");
+    runReductions<double>("double");
+    return 0;
+}
@@ -0,0 +1,110 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Compare sortIndicesSmall() with std::sort for index sequences of 8 to 64 int and
+      float keys (the work behind AscendingOrder on small containers and sort leaves).
+    - Sizes below simd::NetworkMin are listed too, to show why the network is not
+      chosen there.
+    - Compare sortIndicesLeaves() (network leaves, then merges) with std::sort for 128 to
+      1M indices, the sorts behind the permutation of larger containers.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <initializer_list>
+#include <numeric>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "simd/SortingNetwork.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t Sorts = 200000;
+
+template<typename K>
+void run(const char* typeName) {
+    for (size_t n : {size_t(8), size_t(16), size_t(32), size_t(48), simd::NetworkMin, size_t(56), simd::SmallSortMax}) {
+        // A pool of distinct key sets so successive sorts do not see identical input
+        std::vector<std::vector<K>> inputs(64, std::vector<K>(n));
+        unsigned seed = 1;
+        for (auto& keys : inputs) {
+            for (auto& k : keys) {
+                seed = seed * 1103515245u + 12345u;
+                k = static_cast<K>((seed >> 8) % 100000);
+            }
+        }
+        std::vector<size_t> idx(n);
+
+        double stdTime = bench::bestOf(3, [&] {
+            for (size_t s = 0; s < Sorts; ++s) {
+                const K* keys = inputs[s % inputs.size()].data();
+                std::iota(idx.begin(), idx.end(), size_t(0));
+                std::sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+                bench::doNotOptimize(idx[0]);
+            }
+        });
+        double netTime = bench::bestOf(3, [&] {
+            for (size_t s = 0; s < Sorts; ++s) {
+                const K* keys = inputs[s % inputs.size()].data();
+                std::iota(idx.begin(), idx.end(), size_t(0));
+                simd::sortIndicesSmall(keys, idx.data(), idx.data() + n);
+                bench::doNotOptimize(idx[0]);
+            }
+        });
+        std::printf("%-6s %4zu %12.1f %12.1f %8.2fx\n", typeName, n,
+                    stdTime / Sorts * 1e9, netTime / Sorts * 1e9, stdTime / netTime);
+    }
+}
+
+template<typename K>
+void runLeaves(const char* typeName) {
+    for (size_t n : {size_t(128), size_t(1) << 10, size_t(1) << 14, size_t(1) << 20}) {
+        // Enough distinct inputs that the branch predictor cannot learn std::sort's path
+        size_t sorts = std::max<size_t>(1, (size_t(1) << 22) / n);
+        std::vector<std::vector<K>> inputs(std::min<size_t>(sorts, 256), std::vector<K>(n));
+        unsigned seed = 1;
+        for (auto& keys : inputs) {
+            for (auto& k : keys) {
+                seed = seed * 1103515245u + 12345u;
+                k = static_cast<K>((seed >> 8) % 1000000);
+            }
+        }
+        std::vector<size_t> idx(n);
+        std::vector<size_t> scratch(n);
+
+        double stdTime = bench::bestOf(3, [&] {
+            for (size_t s = 0; s < sorts; ++s) {
+                const K* keys = inputs[s % inputs.size()].data();
+                std::iota(idx.begin(), idx.end(), size_t(0));
+                std::sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+                bench::doNotOptimize(idx[0]);
+            }
+        });
+        double leafTime = bench::bestOf(3, [&] {
+            for (size_t s = 0; s < sorts; ++s) {
+                const K* keys = inputs[s % inputs.size()].data();
+                std::iota(idx.begin(), idx.end(), size_t(0));
+                simd::sortIndicesLeaves(keys, idx.data(), idx.data() + n, scratch.data());
+                bench::doNotOptimize(idx[0]);
+            }
+        });
+        std::printf("%-6s %8zu %12.1f %12.1f %8.2fx\n", typeName, n,
+                    stdTime / sorts / n * 1e9, leafTime / sorts / n * 1e9, stdTime / leafTime);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-6s %4s %12s %12s %9s\n", "type", "n", "std ns/sort", "net ns/sort", "speedup");
+    run<int>("int");
+    run<float>("float");
+
+    std::printf("\n%-6s %8s %12s %12s %9s\n", "type", "n", "std ns/elem", "leaf ns/elem", "speedup");
+    runLeaves<int>("int");
+    runLeaves<float>("float");
+    return 0;
+}
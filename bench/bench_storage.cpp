@@ -0,0 +1,55 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Measure add() throughput and the slowest single add() for the contiguous and
+      segmented storage policies. Contiguous growth copies the whole buffer when it
+      outgrows its capacity; segmented growth only allocates a new chunk.
+    - Measure a full AscendingOrder traversal on both, to show the access overhead.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include "BenchUtil.hpp"
+#include "MyContainer.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t Adds = size_t(1) << 24;  // 16M ints
+
+template<typename Container>
+void run(const char* name) {
+    Container c;
+    double worst = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < Adds; ++i) {
+        auto before = std::chrono::steady_clock::now();
+        c.add(static_cast<int>((i * 2654435761u) >> 7));
+        std::chrono::duration<double> one = std::chrono::steady_clock::now() - before;
+        worst = std::max(worst, one.count());
+    }
+    std::chrono::duration<double> total = std::chrono::steady_clock::now() - start;
+
+    double walk = bench::bestOf(1, [&] {
+        long long sum = 0;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            sum += *it;
+        }
+        bench::doNotOptimize(sum);
+    });
+    std::printf("%-11s %14.1f %16.3f %14.3f\n", name, Adds / total.count() / 1e6,
+                worst * 1e3, walk);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-11s %14s %16s %14s\n", "storage", "Madds/s", "worst add (ms)", "ascending (s)");
+    run<MyContainer<int>>("contiguous");
+    run<MyContainer<int, std::allocator<int>, SegmentedStorage>>("segmented");
+    return 0;
+}
@@ -0,0 +1,78 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Feed 1M values through a sliding window of the last 10k and walk SideCrossOrder
+      over the window every 1000 values.
+    - Compare rebuilding a MyContainer from the window for each query with a
+      WindowedContainer, whose sorted copy is updated by add().
+*/
+
+#include <cstdio>
+#include <deque>
+#include "BenchUtil.hpp"
+#include "MyContainer.hpp"
+#include "WindowedContainer.hpp"
+
+using namespace container;
+
+namespace {
+
+constexpr size_t Events = size_t(1) << 20;
+constexpr size_t Window = 10000;
+constexpr size_t QueryEvery = 1000;
+
+double valueAt(size_t i) {
+    return static_cast<double>((i * 2654435761u) % 1000003) / 7.0;
+}
+
+template<typename Container>
+double sideCrossWalk(const Container& c) {
+    double acc = 0;
+    auto end = c.endSideCrossOrder();
+    for (auto it = c.beginSideCrossOrder(); it != end; ++it) {
+        acc = acc * 0.5 + *it;
+    }
+    return acc;
+}
+
+} // namespace
+
+int main() {
+    double rebuild = bench::bestOf(1, [] {
+        std::deque<double> last;
+        double acc = 0;
+        for (size_t i = 0; i < Events; ++i) {
+            last.push_back(valueAt(i));
+            if (last.size() > Window) {
+                last.pop_front();
+            }
+            if (i % QueryEvery == 0) {
+                MyContainer<double> c;
+                c.reserve(last.size());
+                for (double v : last) {
+                    c.add(v);
+                }
+                acc += sideCrossWalk(c);
+            }
+        }
+        bench::doNotOptimize(acc);
+    });
+
+    double windowed = bench::bestOf(1, [] {
+        WindowedContainer<double> w(Window);
+        double acc = 0;
+        for (size_t i = 0; i < Events; ++i) {
+            w.add(valueAt(i));
+            if (i % QueryEvery == 0) {
+                acc += sideCrossWalk(w);
+            }
+        }
+        bench::doNotOptimize(acc);
+    });
+
+    std::printf("%-28s %10s\n", "window of 10k, 1M adds", "time (s)");
+    std::printf("%-28s %10.3f\n", "MyContainer rebuilt", rebuild);
+    std::printf("%-28s %10.3f\n", "WindowedContainer", windowed);
+    return 0;
+}
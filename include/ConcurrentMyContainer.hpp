@@ -0,0 +1,201 @@
+// eitan.derdiger@gmail.com
+
+#ifndef CONCURRENTMYCONTAINER_HPP
+#define CONCURRENTMYCONTAINER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <vector>
+#include "MyContainer.hpp"
+
+/*
+  ConcurrentMyContainer<T> is an ingestion front-end for MyContainer<T> that lets many
+  producer threads call add() at the same time without a global lock.
+
+  Design:
+    - Elements are appended to one of several shards; each thread sticks to the shard
+      it was assigned on its first add() (round-robin), so producers rarely collide.
+    - A shard reserves slots with a single atomic fetch_add and stores them in
+      geometrically growing segments (16, 32, 64, ... slots) that never move, so
+      growth never copies existing elements. A missing segment is installed with CAS.
+    - merge() concatenates the shards (shard by shard, each in its append order) into
+      a regular MyContainer<T>, which then offers all six traversal orders.
+
+  Notes:
+    - add() may run concurrently with other add() calls only; merge(), size() and the
+      destructor expect producers to be quiescent (e.g. after joining them).
+    - Each segment keeps one "constructed" byte per slot after its elements. A slot
+      whose copy constructor (or segment allocation) threw stays reserved but unmarked,
+      so merge() skips it, size() does not count it and the destructor never destroys it.
+*/
+
+namespace container {
+
+template<typename T>
+class ConcurrentMyContainer {
+    static constexpr size_t FirstSegmentBits = 4;  // First segment holds 16 slots
+    static constexpr size_t MaxSegments = 48;      // Enough for 2^52 slots per shard
+
+    // One shard: a lock-free, append-only sequence of slots.
+    struct alignas(64) Shard {
+        std::atomic<size_t> reserved{0};
+        std::atomic<size_t> failed{0};  // Reserved slots whose element was never constructed
+        std::array<std::atomic<T*>, MaxSegments> segments{};
+
+        ~Shard() {
+            size_t n = reserved.load(std::memory_order_acquire);
+            for (size_t s = 0; s < MaxSegments; ++s) {
+                T* seg = segments[s].load(std::memory_order_acquire);
+                if (!seg) continue;
+                size_t first = segmentStart(s);
+                size_t count = first < n ? std::min(n - first, segmentSize(s)) : 0;
+                const unsigned char* constructed = constructedFlags(seg, s);
+                for (size_t i = 0; i < count; ++i) {
+                    if (constructed[i]) seg[i].~T();
+                }
+                ::operator delete(static_cast<void*>(seg), std::align_val_t(alignof(T)));
+            }
+        }
+
+        // Returns the segment for index s, allocating it if no other thread has yet.
+        T* segment(size_t s) {
+            T* seg = segments[s].load(std::memory_order_acquire);
+            if (seg) return seg;
+            T* fresh = static_cast<T*>(::operator new(segmentBytes(s), std::align_val_t(alignof(T))));
+            std::fill_n(constructedFlags(fresh, s), segmentSize(s), static_cast<unsigned char>(0));
+            if (segments[s].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel)) {
+                return fresh;
+            }
+            ::operator delete(static_cast<void*>(fresh), std::align_val_t(alignof(T)));
+            return seg;  // Another producer won the race
+        }
+
+        // True if slot i holds a constructed element.
+        bool holds(size_t i) const {
+            size_t s = segmentOf(i);
+            T* seg = segments[s].load(std::memory_order_acquire);
+            return seg && constructedFlags(seg, s)[i - segmentStart(s)];
+        }
+
+        const T& at(size_t i) const {
+            size_t s = segmentOf(i);
+            return segments[s].load(std::memory_order_acquire)[i - segmentStart(s)];
+        }
+    };
+
+    static size_t segmentSize(size_t s) noexcept {
+        return size_t(1) << (FirstSegmentBits + s);
+    }
+
+    // Elements, then one constructed flag per slot.
+    static size_t segmentBytes(size_t s) noexcept {
+        return segmentSize(s) * (sizeof(T) + 1);
+    }
+
+    static unsigned char* constructedFlags(T* seg, size_t s) noexcept {
+        return reinterpret_cast<unsigned char*>(seg + segmentSize(s));
+    }
+
+    static size_t segmentStart(size_t s) noexcept {
+        return segmentSize(s) - (size_t(1) << FirstSegmentBits);
+    }
+
+    // Segment holding slot i: position of the highest set bit of (i + first segment size).
+    static size_t segmentOf(size_t i) noexcept {
+        size_t v = (i + (size_t(1) << FirstSegmentBits)) >> FirstSegmentBits;
+        size_t s = 0;
+        while (v >>= 1) {
+            ++s;
+        }
+        return s;
+    }
+
+public:
+    /**
+     * @param shardCount Number of independent append buffers
+     *        (default = hardware concurrency, at least 1).
+     */
+    explicit ConcurrentMyContainer(size_t shardCount = std::thread::hardware_concurrency())
+        : shards(std::max<size_t>(shardCount, 1)), id(nextContainerId()) {}
+    ConcurrentMyContainer(const ConcurrentMyContainer&) = delete;
+    ConcurrentMyContainer& operator=(const ConcurrentMyContainer&) = delete;
+    ~ConcurrentMyContainer() = default;
+
+    /**
+     * Appends a value to the calling thread's shard. Safe to call from many threads.
+     * If copying the value (or allocating its segment) throws, nothing is added.
+     */
+    void add(const T& value) {
+        Shard& shard = shards[shardForThisThread()];
+        size_t i = shard.reserved.fetch_add(1, std::memory_order_relaxed);
+        size_t s = segmentOf(i);
+        try {
+            T* seg = shard.segment(s);
+            size_t offset = i - segmentStart(s);
+            new (seg + offset) T(value);
+            constructedFlags(seg, s)[offset] = 1;
+        } catch (...) {
+            shard.failed.fetch_add(1, std::memory_order_relaxed);  // The slot stays a hole
+            throw;
+        }
+    }
+
+    // Total number of elements added (exact once producers are quiescent).
+    size_t size() const noexcept {
+        size_t n = 0;
+        for (const Shard& shard : shards) {
+            n += shard.reserved.load(std::memory_order_acquire) - shard.failed.load(std::memory_order_acquire);
+        }
+        return n;
+    }
+
+    size_t shardCount() const noexcept {
+        return shards.size();
+    }
+
+    // Builds a MyContainer<T> holding every element, shard by shard in append order.
+    MyContainer<T> merge() const {
+        MyContainer<T> out;
+        out.reserve(size());
+        for (const Shard& shard : shards) {
+            size_t n = shard.reserved.load(std::memory_order_acquire);
+            bool holes = shard.failed.load(std::memory_order_acquire) > 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (!holes || shard.holds(i)) {
+                    out.add(shard.at(i));
+                }
+            }
+        }
+        return out;
+    }
+
+private:
+    std::vector<Shard> shards;
+    size_t id;  // Distinguishes containers in the per-thread shard cache
+
+    static size_t nextContainerId() {
+        static std::atomic<size_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Shard assigned to the calling thread (round-robin on first use per container).
+    size_t shardForThisThread() {
+        thread_local size_t cachedId = static_cast<size_t>(-1);
+        thread_local size_t cachedShard = 0;
+        if (cachedId != id) {
+            cachedId = id;
+            cachedShard = nextShard.fetch_add(1, std::memory_order_relaxed) % shards.size();
+        }
+        return cachedShard;
+    }
+
+    std::atomic<size_t> nextShard{0};
+};
+
+} // namespace container
+
+#endif // CONCURRENTMYCONTAINER_HPP
@@ -0,0 +1,411 @@
+// eitan.derdiger@gmail.com
+
+#ifndef EXTERNALCONTAINER_HPP
+#define EXTERNALCONTAINER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+/*
+  ExternalContainer<T> keeps its elements in temporary files instead of memory, for
+  data sets larger than RAM. The sorted orders use an external merge sort whose
+  element buffers never exceed a memory budget.
+
+  Usage:
+      ExternalContainer<long> big(size_t(256) << 20);  // 256 MiB budget
+      for (long v : source) big.add(v);
+      for (auto it = big.beginAscendingOrder(); it != big.endAscendingOrder(); ++it) ...
+
+  How it works:
+    - add() fills a buffer of memoryBudget bytes. A full buffer is appended to the data
+      file (insertion order), then sorted in place and appended to the runs file as one
+      sorted run, so run generation needs no second read of the data.
+    - beginAscendingOrder() / beginDescendingOrder() flush the partial buffer as a last,
+      shorter run and stream a k-way merge of all runs through a loser tree, reading each
+      run in blocks of memoryBudget / k bytes (DescendingOrder reads the runs backwards).
+    - With more runs than fanIn() (blocks would drop below BlockMin bytes), merge passes
+      first combine them into fewer, longer runs; the result is kept for later traversals.
+    - beginOrder() streams the data file in insertion order.
+
+  Notes:
+    - T must be trivially copyable; elements are written as raw bytes.
+    - Files are created with mkstemp() in tempDir (default: $TMPDIR, else /tmp) and
+      unlinked at once, so they disappear with the container, even after a crash.
+    - Iterators are single-pass input iterators (copies share the read position). They
+      keep the files they read open, so an iterator sees the elements present when it
+      was created, whatever add() does afterwards.
+    - I/O failures throw std::runtime_error.
+*/
+
+namespace container {
+
+namespace detail {
+
+// An anonymous temporary file, written only by appending.
+class TempFile {
+public:
+    explicit TempFile(const std::string& dir) {
+        std::string path = dir + "/mycontainer-XXXXXX";
+        fd = ::mkstemp(&path[0]);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create a temporary file in " + dir);
+        }
+        ::unlink(path.c_str());
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile() { ::close(fd); }
+
+    void append(const void* data, size_t bytes) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t n = ::pwrite(fd, p, bytes, static_cast<off_t>(length));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                throw std::runtime_error("Write to temporary file failed");
+            }
+            p += n;
+            bytes -= static_cast<size_t>(n);
+            length += static_cast<uint64_t>(n);
+        }
+    }
+
+    void read(uint64_t offset, void* data, size_t bytes) const {
+        char* p = static_cast<char*>(data);
+        while (bytes > 0) {
+            ssize_t n = ::pread(fd, p, bytes, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                throw std::runtime_error("Read from temporary file failed");
+            }
+            p += n;
+            bytes -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+    }
+
+    uint64_t size() const noexcept { return length; }
+
+private:
+    int fd = -1;
+    uint64_t length = 0;
+};
+
+} // namespace detail
+
+template<typename T>
+class ExternalContainer {
+    static_assert(std::is_trivially_copyable_v<T>, "ExternalContainer stores T as raw bytes");
+
+public:
+    // Smallest read block of a merge; fewer, larger runs are merged first below it.
+    static constexpr size_t BlockMin = size_t(4) << 10;
+    static constexpr size_t DefaultBudget = size_t(64) << 20;
+
+    static_assert(sizeof(T) <= BlockMin, "T is too large for a merge block");
+
+private:
+    // A sorted run: `count` elements starting at element `first` of the runs file.
+    struct Run {
+        uint64_t first;
+        uint64_t count;
+    };
+
+    // Streams one run (or the data file) in blocks, forwards or backwards.
+    class RunReader {
+    public:
+        RunReader(std::shared_ptr<const detail::TempFile> file, Run run, size_t blockElems, bool backwards)
+            : file(std::move(file)), run(run), blockElems(std::max<size_t>(1, blockElems)),
+              backwards(backwards) {
+            fill();
+        }
+
+        bool done() const noexcept { return pos == block.size(); }
+        const T& head() const noexcept { return block[pos]; }
+
+        void advance() {
+            if (++pos == block.size()) {
+                fill();
+            }
+        }
+
+    private:
+        void fill() {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(blockElems, run.count - taken));
+            block.resize(n);
+            pos = 0;
+            if (n == 0) return;
+            uint64_t at = backwards ? run.first + run.count - taken - n : run.first + taken;
+            file->read(at * sizeof(T), block.data(), n * sizeof(T));
+            if (backwards) {
+                std::reverse(block.begin(), block.end());
+            }
+            taken += n;
+        }
+
+        std::shared_ptr<const detail::TempFile> file;
+        Run run;
+        size_t blockElems;
+        bool backwards;
+        uint64_t taken = 0;
+        std::vector<T> block;
+        size_t pos = 0;
+    };
+
+    // k-way merge of RunReaders with a loser tree, ascending or descending.
+    class Merge {
+    public:
+        Merge(std::vector<RunReader> readers, bool descending)
+            : readers(std::move(readers)), descending(descending) {
+            while (leaves < this->readers.size()) {
+                leaves <<= 1;
+            }
+            losers.assign(leaves, 0);
+            losers[0] = build(1);
+        }
+
+        bool done() const noexcept { return readers.empty() || readers[losers[0]].done(); }
+        const T& top() const noexcept { return readers[losers[0]].head(); }
+
+        void pop() {
+            size_t winner = losers[0];
+            readers[winner].advance();
+            // Replay the winner's path from its leaf to the root
+            for (size_t node = (winner + leaves) / 2; node >= 1; node /= 2) {
+                if (beats(losers[node], winner)) {
+                    std::swap(losers[node], winner);
+                }
+            }
+            losers[0] = winner;
+        }
+
+    private:
+        // Does reader a currently beat reader b? Exhausted (and padding) readers lose to everything.
+        bool beats(size_t a, size_t b) const {
+            bool aDone = a >= readers.size() || readers[a].done();
+            bool bDone = b >= readers.size() || readers[b].done();
+            if (aDone || bDone) return !aDone;
+            const T& x = readers[a].head();
+            const T& y = readers[b].head();
+            if (descending ? x < y : y < x) return false;
+            if (descending ? y < x : x < y) return true;
+            return a < b;
+        }
+
+        size_t build(size_t node) {
+            if (node >= leaves) return node - leaves;
+            size_t left = build(2 * node);
+            size_t right = build(2 * node + 1);
+            if (beats(left, right)) {
+                losers[node] = right;
+                return left;
+            }
+            losers[node] = left;
+            return right;
+        }
+
+        std::vector<RunReader> readers;
+        bool descending;
+        size_t leaves = 1;
+        std::vector<size_t> losers;  // losers[node] lost the match at node; losers[0] is the winner
+    };
+
+public:
+    // Single-pass iterator over a streamed traversal; copies share the read position.
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = T;
+        using pointer           = const T*;
+        using reference         = const T&;
+        using difference_type   = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        const T& operator*() const {
+            if (atEnd()) {
+                throw std::runtime_error("Iterator out of range");
+            }
+            return merge->top();
+        }
+
+        const T* operator->() const { return &**this; }
+
+        Iterator& operator++() {
+            if (atEnd()) {
+                throw std::runtime_error("Increment past end");
+            }
+            merge->pop();
+            return *this;
+        }
+
+        // Equal when both are at the end or both read the same stream
+        bool operator==(const Iterator& other) const {
+            bool end = atEnd();
+            return end == other.atEnd() && (end || merge == other.merge);
+        }
+
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class ExternalContainer;
+
+        explicit Iterator(std::shared_ptr<Merge> merge) : merge(std::move(merge)) {}
+
+        bool atEnd() const noexcept { return !merge || merge->done(); }
+
+        std::shared_ptr<Merge> merge;
+    };
+
+    using Order = Iterator;
+    using AscendingOrder = Iterator;
+    using DescendingOrder = Iterator;
+
+    /**
+     * @param memoryBudget Bytes of element buffers used by add() and by the merges.
+     * @param tempDir Directory for the data and run files; empty means $TMPDIR, else /tmp.
+     * @throws std::runtime_error if memoryBudget is below 4 * BlockMin or no file can be created.
+     */
+    explicit ExternalContainer(size_t memoryBudget = DefaultBudget, std::string tempDir = "")
+        : budget(memoryBudget), dir(std::move(tempDir)) {
+        if (budget < 4 * BlockMin) {
+            throw std::runtime_error("Memory budget must be at least " + std::to_string(4 * BlockMin) + " bytes");
+        }
+        if (dir.empty()) {
+            const char* env = std::getenv("TMPDIR");
+            dir = (env && *env) ? env : "/tmp";
+        }
+        dataFile = std::make_shared<detail::TempFile>(dir);
+        runsFile = std::make_shared<detail::TempFile>(dir);
+    }
+
+    ExternalContainer(const ExternalContainer&) = delete;
+    ExternalContainer& operator=(const ExternalContainer&) = delete;
+    ExternalContainer(ExternalContainer&&) = default;
+    ExternalContainer& operator=(ExternalContainer&&) = default;
+
+    void add(const T& value) {
+        if (pending.capacity() == 0) {
+            pending.reserve(bufferElems());
+        }
+        pending.push_back(value);
+        if (pending.size() == bufferElems()) {
+            spill();
+        }
+    }
+
+    size_t size() const noexcept { return static_cast<size_t>(stored + pending.size()); }
+    size_t memoryBudget() const noexcept { return budget; }
+
+    // Sorted runs on disk (the unflushed buffer not counted).
+    size_t runCount() const noexcept { return runs.size(); }
+
+    // Most runs merged at once: blocks of at least BlockMin bytes, plus one output block.
+    size_t fanIn() const noexcept { return budget / BlockMin - 1; }
+
+    Iterator beginOrder() {
+        flush();
+        Run all{0, stored};
+        std::vector<RunReader> readers;
+        readers.emplace_back(dataFile, all, bufferElems(), false);
+        return Iterator(std::make_shared<Merge>(std::move(readers), false));
+    }
+
+    Iterator endOrder() const { return Iterator(); }
+
+    Iterator beginAscendingOrder() { return sorted(false); }
+    Iterator endAscendingOrder() const { return Iterator(); }
+
+    Iterator beginDescendingOrder() { return sorted(true); }
+    Iterator endDescendingOrder() const { return Iterator(); }
+
+private:
+    size_t bufferElems() const noexcept { return budget / sizeof(T); }
+
+    // Writes the buffered elements to the data file and, sorted, as a new run.
+    void spill() {
+        if (pending.empty()) return;
+        dataFile->append(pending.data(), pending.size() * sizeof(T));
+        std::sort(pending.begin(), pending.end());
+        runs.push_back(Run{runsFile->size() / sizeof(T), pending.size()});
+        runsFile->append(pending.data(), pending.size() * sizeof(T));
+        stored += pending.size();
+        pending.clear();
+    }
+
+    // Spills a partial buffer and returns its memory to the budget for merging.
+    void flush() {
+        spill();
+        std::vector<T>().swap(pending);
+    }
+
+    Iterator sorted(bool descending) {
+        flush();
+        collapseRuns();
+        std::vector<RunReader> readers;
+        size_t blockElems = runs.empty() ? 1 : bufferElems() / runs.size();
+        for (const Run& run : runs) {
+            readers.emplace_back(runsFile, run, blockElems, descending);
+        }
+        return Iterator(std::make_shared<Merge>(std::move(readers), descending));
+    }
+
+    // Merge passes until at most fanIn() runs remain.
+    void collapseRuns() {
+        size_t width = fanIn();
+        while (runs.size() > width) {
+            auto next = std::make_shared<detail::TempFile>(dir);
+            std::vector<Run> merged;
+            size_t blockElems = bufferElems() / (width + 1);
+            std::vector<T> out;
+            out.reserve(blockElems);
+            for (size_t g = 0; g < runs.size(); g += width) {
+                size_t groupEnd = std::min(runs.size(), g + width);
+                std::vector<RunReader> readers;
+                for (size_t r = g; r < groupEnd; ++r) {
+                    readers.emplace_back(runsFile, runs[r], blockElems, false);
+                }
+                Merge merge(std::move(readers), false);
+                Run run{next->size() / sizeof(T), 0};
+                for (; !merge.done(); merge.pop()) {
+                    out.push_back(merge.top());
+                    if (out.size() == blockElems) {
+                        next->append(out.data(), out.size() * sizeof(T));
+                        run.count += out.size();
+                        out.clear();
+                    }
+                }
+                next->append(out.data(), out.size() * sizeof(T));
+                run.count += out.size();
+                out.clear();
+                merged.push_back(run);
+            }
+            runsFile = std::move(next);
+            runs = std::move(merged);
+        }
+    }
+
+    size_t budget;
+    std::string dir;
+    std::shared_ptr<detail::TempFile> dataFile;
+    std::shared_ptr<detail::TempFile> runsFile;
+    std::vector<Run> runs;
+    std::vector<T> pending;   // Elements not yet on disk
+    uint64_t stored = 0;      // Elements in the data file
+};
+
+} // namespace container
+
+#endif // EXTERNALCONTAINER_HPP
@@ -5,10 +5,24 @@
 
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include <stdexcept>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
 #include <type_traits>
+#include <utility>
+#include "Stats.hpp"
+#include "simd/Kernels.hpp"
+#include "simd/SortingNetwork.hpp"
+#include "iterators/IndexSequence.hpp"
+#include "iterators/ScratchArena.hpp"
+#include "io/Format.hpp"
+#include "io/Parse.hpp"
+#include "storage/StoragePolicy.hpp"
 
 /*
   MyContainer<T> is a generic container for comparable elements.
@@ -21,6 +35,39 @@
         Order, AscendingOrder, DescendingOrder,
         ReverseOrder, SideCrossOrder, MiddleOutOrder.
   Each nested iterator class is defined in a separate header under include/iterators/.
+
+  Storage is copy-on-write: elements live in a shared, reference-counted buffer.
+  Iterators pin the buffer version they were created from (an O(1) refcount bump),
+  and add()/remove() copy the buffer only while such a snapshot is outstanding.
+
+  The ascending index permutation (used by AscendingOrder, DescendingOrder and
+  SideCrossOrder) is built once per buffer version and cached. Elements appended with
+  addSortedRun() are remembered as sorted runs, so that permutation is produced by a
+  k-way merge instead of a full sort. Iterators over containers of at most 16 elements
+  keep their index sequence inline and never allocate (see iterators/IndexSequence.hpp).
+
+  Every buffer the container owns (the elements, the cached permutation, larger
+  iterator sequences and the run list) comes from the Alloc template argument, rebound
+  as needed; container::pmr::MyContainer<T> takes a std::pmr::memory_resource instead.
+  With the default std::allocator, iterator sequences are drawn from a per-thread
+  ScratchArena, so repeated begin/end constructions reuse released buffers. Per-call
+  temporaries (the run list and scratch of the permutation merge, the partial results
+  of parallel_reduce) are drawn the same way. Copies between containers with unequal
+  allocators copy the buffers instead of sharing them. The one exception is the
+  work-stealing pool's job bookkeeping (parallel_for_each, parallel_reduce, and merges
+  of more than 32k indices), which uses the global heap.
+
+  The Policy argument picks the element buffer (see storage/StoragePolicy.hpp):
+  ContiguousStorage keeps one std::vector; SegmentedStorage keeps fixed-size chunks,
+  so add() never moves existing elements when the container grows.
+
+  With deferRemoval(true), remove() marks slots dead in a bitmap instead of shifting
+  the elements after them; every order, query and reduction skips dead slots, and
+  compact() squeezes them out (automatically once they pass a set share of the buffer).
+
+  Built with -DMYCONTAINER_STATS, each container counts the index sequences its
+  iterators build, permutation sorts and cache hits, and elements shifted by removal;
+  stats() returns them and ContainerStats::toJson() dumps them (see Stats.hpp).
 */
 
 namespace container {
@@ -29,8 +76,10 @@ namespace container {
  * A generic container for comparable elements that supports
  * dynamic insertion, removal, and multiple custom traversal orders.
  * @param T: A type that supports operator< and operator==.
+ * @param Alloc: Allocator for T; rebound for the container's index buffers.
+ * @param Policy: Element buffer layout, ContiguousStorage or SegmentedStorage.
  */
-template<typename T>
+template<typename T, typename Alloc = std::allocator<T>, typename Policy = ContiguousStorage>
 class MyContainer {
     static_assert(std::is_copy_constructible_v<T>, "T must be copy constructible");
     static_assert(std::is_copy_assignable_v<T>, "T must be copy assignable");
@@ -46,8 +95,206 @@ class MyContainer {
     static_assert(decltype(check_less<T>(0))::value, "T must support operator<");
     static_assert(decltype(check_equal<T>(0))::value, "T must support operator==");
 
+    template<typename U>
+    using Rebind = typename std::allocator_traits<Alloc>::template rebind_alloc<U>;
+
+public:
+    using allocator_type = Alloc;
+    using Storage = typename Policy::template Buffer<T, Alloc>;  // Element buffer (insertion order)
+    using IndexVector = std::vector<size_t, Rebind<size_t>>;  // Index permutation buffer
+
 private:
-    std::vector<T> elements;  // Underlying storage (in insertion order)
+    Alloc alloc;
+    std::shared_ptr<Storage> elements;  // Shared copy-on-write buffer (null when empty)
+
+    // Read-only view of the current buffer version.
+    const Storage& data() const noexcept {
+        static const Storage empty;
+        return elements ? *elements : empty;
+    }
+
+    // A contiguous range of elements ending at `end`; sorted if added via addSortedRun().
+    struct Run {
+        size_t end;
+        bool sorted;
+    };
+    std::vector<Run, Rebind<Run>> runs{Rebind<Run>(alloc)};  // Empty unless addSortedRun() was used
+
+    // Running extremes, maintained by add()/remove() while tracking is enabled.
+    bool extremaTracking = false;
+    std::optional<std::pair<T, T>> extrema;  // Empty when not tracking or no elements
+
+    // Widens the tracked extremes to include [lo, hi].
+    void widenExtrema(const T& lo, const T& hi) {
+        if (!extrema) {
+            extrema.emplace(lo, hi);
+            return;
+        }
+        if (lo < extrema->first) extrema->first = lo;
+        if (extrema->second < hi) extrema->second = hi;
+    }
+
+    // Ascending permutation of the current buffer version (null until first needed):
+    // a computed IndexVector, or one adopted with the buffer (e.g. from a mapped file).
+    // Accessed only through std::atomic_load / std::atomic_store.
+    mutable std::shared_ptr<const IndexSequence> sortedCache;
+
+    // Deferred removal: bit i of dead marks slot i of the buffer as removed. Bits past
+    // the end of dead are live. deadCount > 0 only while removal is deferred.
+    bool deferredRemoval = false;
+    double compactRatio = 0.25;
+    std::vector<uint64_t, Rebind<uint64_t>> dead{Rebind<uint64_t>(alloc)};
+    size_t deadCount = 0;
+
+#ifdef MYCONTAINER_STATS
+    mutable detail::StatCounters counters;  // Hot-path counters, see Stats.hpp
+
+    // Records an iterator sequence; only heap sequences count as allocated bytes.
+    void countSequence(Traversal order, const IndexSequence& seq, bool allocated = true) const noexcept {
+        counters.sequence(order, allocated && !seq.isInline() ? seq.size() * sizeof(size_t) : 0);
+    }
+
+    static uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start) noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+#endif
+
+    bool isDead(size_t slot) const noexcept {
+        size_t word = slot / 64;
+        return word < dead.size() && ((dead[word] >> (slot % 64)) & 1u);
+    }
+
+    void markDead(size_t slot) {
+        size_t word = slot / 64;
+        if (word >= dead.size()) {
+            dead.resize(word + 1, 0);
+        }
+        dead[word] |= uint64_t(1) << (slot % 64);
+        ++deadCount;
+    }
+
+    // First dead slot in [from, limit), or limit if there is none.
+    size_t nextDead(size_t from, size_t limit) const noexcept {
+        for (size_t word = from / 64; word < dead.size() && word * 64 < limit; ++word) {
+            uint64_t bits = dead[word];
+            if (word == from / 64) {
+                bits &= ~uint64_t(0) << (from % 64);
+            }
+            if (bits) {
+                return std::min(limit, word * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+            }
+        }
+        return limit;
+    }
+
+    // Number of live slots before `slot`.
+    size_t liveBefore(size_t slot) const noexcept {
+        size_t deadBefore = 0;
+        for (size_t word = 0; word < dead.size() && word * 64 < slot; ++word) {
+            uint64_t bits = dead[word];
+            if (slot - word * 64 < 64) {
+                bits &= (uint64_t(1) << (slot - word * 64)) - 1;
+            }
+            deadBefore += static_cast<size_t>(__builtin_popcountll(bits));
+        }
+        return slot - deadBefore;
+    }
+
+    // Calls fn(const T* first, size_t n) for every contiguous stretch of live elements.
+    template<typename Fn>
+    void forEachLiveSpan(const Storage& elems, Fn fn) const {
+        size_t n = elems.size();
+        size_t slot = 0;
+        while (slot < n) {
+            size_t stop = deadCount == 0 ? n : nextDead(slot, n);
+            storage::forEachSpan(elems, slot, stop, fn);
+            slot = stop;
+            while (slot < n && isDead(slot)) {
+                ++slot;
+            }
+        }
+    }
+
+    // Writes the buffer slot of every live position p (0..size()-1) to out[rank(p)], in
+    // one pass over the dead-slot bitmap, so index-only orders skip tombstones.
+    template<typename Rank>
+    void scatterLiveSlots(size_t* out, Rank rank) const noexcept {
+        size_t slots = data().size();
+        size_t position = 0;
+        for (size_t word = 0; word * 64 < slots; ++word) {
+            uint64_t live = ~(word < dead.size() ? dead[word] : uint64_t(0));
+            if (slots - word * 64 < 64) {
+                live &= (uint64_t(1) << (slots - word * 64)) - 1;
+            }
+            while (live) {
+                out[rank(position++)] = word * 64 + static_cast<size_t>(__builtin_ctzll(live));
+                live &= live - 1;
+            }
+        }
+    }
+
+    // Writable buffer; detaches from any snapshot still holding the current version.
+    Storage& mutableData() {
+        std::atomic_store(&sortedCache, std::shared_ptr<const IndexSequence>());
+        if (!elements) {
+            elements = detail::allocateShared<Storage>(alloc);
+        } else if (elements.use_count() > 1) {
+            elements = detail::allocateShared<Storage>(alloc, *elements);
+        }
+        return *elements;
+    }
+
+    // Takes other's element buffer and cached permutation. They are shared when the two
+    // allocators are equal; otherwise they are copied with this container's allocator,
+    // since other's memory (e.g. a per-request arena) may be released before this copy.
+    void copyBuffers(const MyContainer& other) {
+        auto cached = std::atomic_load(&other.sortedCache);
+        std::shared_ptr<Storage> buffer = other.elements;
+        if (buffer && !(alloc == other.alloc)) {
+            buffer = detail::allocateShared<Storage>(alloc, *buffer);
+            if (cached) {
+                auto copied = detail::allocateShared<IndexVector>(indexAllocator(), cached->data(),
+                                                                  cached->data() + cached->size());
+                cached = std::allocate_shared<IndexSequence>(indexAllocator(),
+                                                             std::shared_ptr<const IndexVector>(copied));
+            }
+        }
+        elements = std::move(buffer);
+        std::atomic_store(&sortedCache, cached);
+    }
+
+    Rebind<size_t> indexAllocator() const {
+        return Rebind<size_t>(alloc);
+    }
+
+    // Allocator for iterator index sequences and other per-call temporaries (merge
+    // runs, reduction partials): the calling thread's scratch arena for default-allocated
+    // containers, otherwise the container's own allocator.
+    template<typename U = size_t>
+    auto sequenceAllocator() const {
+        if constexpr (std::is_same_v<Alloc, std::allocator<T>>) {
+            return ScratchAllocator<U>();
+        } else {
+            return Rebind<U>(alloc);
+        }
+    }
+
+    // Returns the cached ascending permutation, building it on first use.
+    std::shared_ptr<const IndexSequence> sortedIndices() const;
+
+    // Ascending permutation as an iterator sequence; small containers sort into the
+    // sequence's inline storage instead of building the shared cache.
+    IndexSequence ascendingSequence() const;
+
+    // Index permutation that visits the given buffer in ascending order.
+    IndexVector buildSortedIndices(const Storage& elems) const;
+
+    // Sorts indices [first, last) (ascending on entry) by element value. Contiguous
+    // arithmetic elements of at most 32 bits use the branch-free sorting network: alone
+    // for short ranges, as the leaves of a merge sort for longer ones (see
+    // simd/SortingNetwork.hpp); other ranges use std::sort.
+    void sortIndexRange(size_t* first, size_t* last, const Storage& elems) const;
 
     // Grant access to nested iterator classes
     template<typename ContainerType, typename ValueType>
@@ -61,47 +308,381 @@ private:
 
 public:
     MyContainer() = default;
-    MyContainer(const MyContainer& other) = default;
-    MyContainer& operator=(const MyContainer& other) = default;
-    MyContainer(MyContainer&& other) noexcept = default;
-    MyContainer& operator=(MyContainer&& other) noexcept = default;
+
+    /**
+     * @param allocator Allocator (or, for container::pmr::MyContainer, the memory
+     *        resource) used for every buffer of this container.
+     */
+    explicit MyContainer(const Alloc& allocator) : alloc(allocator) {}
+
+    /**
+     * Adopts an existing element buffer (e.g. one read by io::load() or mapped by
+     * io::openMapped()); the container takes the buffer's allocator.
+     */
+    explicit MyContainer(std::shared_ptr<Storage> buffer)
+        : alloc(buffer ? buffer->get_allocator() : Alloc()), elements(std::move(buffer)) {}
+
+    /**
+     * Adopts a buffer together with its ascending permutation (as returned by
+     * ascendingPermutation()), so the sorted orders need no sort. The permutation is
+     * trusted, not checked.
+     * @throws std::runtime_error if its length differs from the buffer's.
+     */
+    MyContainer(std::shared_ptr<Storage> buffer, IndexSequence ascending)
+        : MyContainer(std::move(buffer)) {
+        if (ascending.size() != size()) {
+            throw std::runtime_error("Permutation does not match the elements");
+        }
+        if (ascending.size() > 0) {
+            sortedCache = std::allocate_shared<IndexSequence>(indexAllocator(), std::move(ascending));
+        }
+    }
+
+    // Copies share the element buffer; the allocator follows the std container rules.
+    MyContainer(const MyContainer& other)
+        : MyContainer(other, std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc)) {}
+
+    MyContainer(const MyContainer& other, const Alloc& allocator)
+        : alloc(allocator), runs(other.runs.begin(), other.runs.end(), Rebind<Run>(allocator)),
+          extremaTracking(other.extremaTracking), extrema(other.extrema),
+          deferredRemoval(other.deferredRemoval), compactRatio(other.compactRatio),
+          dead(other.dead.begin(), other.dead.end(), Rebind<uint64_t>(allocator)),
+          deadCount(other.deadCount) {
+        copyBuffers(other);
+    }
+
+    // Assignment keeps this container's allocator; the buffers are shared only when it
+    // equals other's (see copyBuffers()).
+    MyContainer& operator=(const MyContainer& other) {
+        if (this != &other) {
+            copyBuffers(other);
+            runs.assign(other.runs.begin(), other.runs.end());
+            extremaTracking = other.extremaTracking;
+            extrema = other.extrema;
+            deferredRemoval = other.deferredRemoval;
+            compactRatio = other.compactRatio;
+            dead.assign(other.dead.begin(), other.dead.end());
+            deadCount = other.deadCount;
+        }
+        return *this;
+    }
+
+    // The moved-from container is left empty (its dead-slot count and tracked extremes
+    // are reset too); it keeps its tracking and removal settings.
+    MyContainer(MyContainer&& other) noexcept
+        : alloc(std::move(other.alloc)), elements(std::move(other.elements)), runs(std::move(other.runs)),
+          extremaTracking(other.extremaTracking), extrema(std::exchange(other.extrema, std::nullopt)),
+          sortedCache(std::move(other.sortedCache)),
+          deferredRemoval(other.deferredRemoval), compactRatio(other.compactRatio),
+          dead(std::move(other.dead)), deadCount(std::exchange(other.deadCount, 0)) {}
+
+    MyContainer& operator=(MyContainer&& other) noexcept(
+        std::is_nothrow_move_assignable_v<std::vector<Run, Rebind<Run>>>) {
+        if (this != &other) {
+            elements = std::move(other.elements);
+            runs = std::move(other.runs);
+            extremaTracking = other.extremaTracking;
+            extrema = std::exchange(other.extrema, std::nullopt);
+            sortedCache = std::move(other.sortedCache);
+            deferredRemoval = other.deferredRemoval;
+            compactRatio = other.compactRatio;
+            dead = std::move(other.dead);
+            deadCount = std::exchange(other.deadCount, 0);
+        }
+        return *this;
+    }
+
     ~MyContainer() = default;
 
+    Alloc get_allocator() const noexcept {
+        return alloc;
+    }
+
     //Insert a new element into the container.
     void add(const T& value) {
-        elements.push_back(value);
+        mutableData().push_back(value);
+        if (extremaTracking) {
+            widenExtrema(value, value);
+        }
+    }
+
+    /**
+     * Builds a container from text (arithmetic T only): operator<< output such as
+     * "[1, 2, 3]", or numbers separated by commas and/or whitespace, e.g. one per line.
+     * Numbers are read with std::from_chars after one upfront reservation; streams are
+     * read in 1 MiB chunks (see io/Parse.hpp).
+     * @throws std::runtime_error on a token that is not a number of type T.
+     */
+    static MyContainer parse(std::string_view text, const Alloc& allocator = Alloc()) {
+        MyContainer c(allocator);
+        io::parseInto<T>(c.mutableData(), text);
+        return c;
+    }
+
+    static MyContainer parse(std::istream& in, const Alloc& allocator = Alloc()) {
+        MyContainer c(allocator);
+        io::parseInto<T>(c.mutableData(), in);
+        return c;
+    }
+
+    // Pre-allocates room for at least capacity elements (avoids regrowth during bulk adds).
+    void reserve(size_t capacity) {
+        mutableData().reserve(capacity);
     }
 
     /**
-     * Removes all occurrences of a given element.
+     * Removes all occurrences of a given element. With deferred removal the matching
+     * slots are only marked dead (see deferRemoval()).
      * @throws std::runtime_error if the element is not found.
      */
     void remove(const T& value) {
-        size_t originalSize = elements.size();
-        elements.erase(
-            std::remove(elements.begin(), elements.end(), value),
-            elements.end()
-        );
-        if (elements.size() == originalSize) {
+        if (deferredRemoval) {
+            removeDeferred(value);
+            return;
+        }
+        // Look first so a failed removal never detaches a shared buffer.
+        if (!contains(value)) {
             throw std::runtime_error("Element not found in container");
         }
+        if (!runs.empty()) {
+            shrinkRuns(data(), value);
+        }
+        MYCONTAINER_STAT(size_t firstMatch = 0;
+                         while (!(data()[firstMatch] == value)) ++firstMatch;)
+        Storage& buf = mutableData();
+        storage::removeAll(buf, value);
+        // Every element kept behind the first match moved
+        MYCONTAINER_STAT(counters.add(counters.removes);
+                         counters.add(counters.elementsShifted, buf.size() - firstMatch);)
+
+        rescanExtremaAfterRemoving(value);
     }
 
-    // Returns the number of elements currently stored.
-    size_t size() const noexcept {
-        return elements.size();
+    /**
+     * Enables or disables deferred removal. While enabled, remove() makes one pass that
+     * marks matching slots dead in a bitmap and moves no elements; compact() runs once
+     * the dead slots exceed compactRatio of the buffer. Disabling compacts immediately.
+     * @throws std::runtime_error if compactRatio is not in (0, 1].
+     */
+    void deferRemoval(bool enabled, double ratio = 0.25) {
+        if (!(ratio > 0.0 && ratio <= 1.0)) {
+            throw std::runtime_error("Compaction ratio must be in (0, 1]");
+        }
+        deferredRemoval = enabled;
+        compactRatio = ratio;
+        if (!enabled) {
+            compact();
+        }
     }
 
-    // Prints the container in a human-readable format: [a, b, c]
-    friend std::ostream& operator<<(std::ostream& os, const MyContainer<T>& cont) {
-        os << "[";
-        for (size_t i = 0; i < cont.elements.size(); ++i) {
-            os << cont.elements[i];
-            if (i + 1 < cont.elements.size()) {
-                os << ", ";
+    bool defersRemoval() const noexcept {
+        return deferredRemoval;
+    }
+
+    // Number of removed slots still held in the buffer (0 unless removal is deferred).
+    size_t deadSlots() const noexcept {
+        return deadCount;
+    }
+
+    // Drops all dead slots from the buffer in one stable pass.
+    void compact() {
+        if (deadCount == 0) return;
+        if (!runs.empty()) {
+            std::vector<Run, Rebind<Run>> kept{Rebind<Run>(alloc)};
+            for (const Run& run : runs) {
+                size_t newEnd = liveBefore(run.end);
+                if (newEnd > (kept.empty() ? 0 : kept.back().end)) {
+                    kept.push_back(Run{newEnd, run.sorted});
+                }
             }
+            runs.swap(kept);
+        }
+        MYCONTAINER_STAT(size_t firstDead = nextDead(0, data().size());)
+        Storage& buf = mutableData();
+        storage::eraseSlots(buf, [this](size_t slot) { return isDead(slot); });
+        MYCONTAINER_STAT(counters.add(counters.compactions);
+                         counters.add(counters.elementsShifted, buf.size() - firstDead);)
+        dead.clear();
+        deadCount = 0;
+    }
+
+    // Returns the number of elements equal to value (vectorized for 32-bit int/float).
+    size_t count(const T& value) const {
+        if (deadCount == 0) {
+            const Storage& elems = data();
+            return countIn(elems, 0, elems.size(), value);
+        }
+        size_t total = 0;
+        forEachLiveSpan(data(), [&](const T* first, size_t n) {
+            total += simd::count(first, n, value);
+        });
+        return total;
+    }
+
+    // Returns true if at least one element equals value (vectorized for 32-bit int/float).
+    bool contains(const T& value) const {
+        bool found = false;
+        forEachLiveSpan(data(), [&](const T* first, size_t n) {
+            found = found || simd::find(first, n, value) != n;
+        });
+        return found;
+    }
+
+    /**
+     * Appends a run of values that is already in ascending order. The sorted
+     * permutation then merges such runs instead of re-sorting them.
+     * @throws std::runtime_error if run is not sorted (nothing is added).
+     */
+    void addSortedRun(const std::vector<T>& run) {
+        if (!std::is_sorted(run.begin(), run.end())) {
+            throw std::runtime_error("Run is not sorted");
+        }
+        if (run.empty()) return;
+        Storage& buf = mutableData();
+        size_t tailStart = runs.empty() ? 0 : runs.back().end;
+        if (buf.size() > tailStart) {
+            runs.push_back(Run{buf.size(), false});  // Close the unsorted tail
         }
-        os << "]";
+        storage::append(buf, run.begin(), run.end());
+        runs.push_back(Run{buf.size(), true});
+        if (extremaTracking) {
+            widenExtrema(run.front(), run.back());
+        }
+    }
+
+    /**
+     * Enables or disables running min/max tracking. While enabled, add() keeps the
+     * extremes up to date and remove() rescans only when it removes a current extreme,
+     * so min(), max() and minmax() are O(1). Enabling costs one scan.
+     */
+    void trackExtrema(bool enabled) {
+        extremaTracking = enabled;
+        extrema.reset();
+        if (enabled && size() > 0) {
+            extrema = scanMinmax(data());
+        }
+    }
+
+    bool tracksExtrema() const noexcept {
+        return extremaTracking;
+    }
+
+    // Returns the number of elements currently stored (dead slots excluded).
+    size_t size() const noexcept {
+        return data().size() - deadCount;
+    }
+
+    /**
+     * Smallest / largest element: O(1) while extrema are tracked (see trackExtrema()),
+     * otherwise found in one pass (vectorized for int32_t, float and double).
+     * Either way no sort is needed; min()/max() equal the first element of
+     * AscendingOrder/DescendingOrder.
+     * @throws std::runtime_error if the container is empty.
+     */
+    T min() const {
+        return minmax().first;
+    }
+
+    T max() const {
+        return minmax().second;
+    }
+
+    std::pair<T, T> minmax() const {
+        if (size() == 0) {
+            throw std::runtime_error("Container is empty");
+        }
+        if (extrema) {
+            return *extrema;
+        }
+        return scanMinmax(data());
+    }
+
+    /**
+     * Sum of all elements (arithmetic T only), accumulated in simd::SumType<T>.
+     * Returns 0 for an empty container.
+     */
+    simd::SumType<T> sum() const {
+        simd::SumType<T> total{};
+        forEachLiveSpan(data(), [&](const T* first, size_t n) {
+            total += simd::sum(first, n);
+        });
+        return total;
+    }
+
+    /**
+     * Arithmetic mean of all elements (arithmetic T only).
+     * @throws std::runtime_error if the container is empty.
+     */
+    double mean() const {
+        if (size() == 0) {
+            throw std::runtime_error("Container is empty");
+        }
+        return static_cast<double>(sum()) / static_cast<double>(size());
+    }
+
+    /**
+     * Positions (as visited by Order) of the elements in ascending order. Shares the
+     * cached permutation, building it if needed; copies it only while removals are
+     * deferred, since dead slots shift the positions.
+     */
+    IndexSequence ascendingPermutation() const {
+        std::shared_ptr<const IndexSequence> sorted = sortedIndices();
+        if (deadCount == 0) {
+            return *sorted;
+        }
+        IndexVector position(data().size(), 0, indexAllocator());
+        for (size_t slot = 0, live = 0; slot < position.size(); ++slot) {
+            if (!isDead(slot)) position[slot] = live++;
+        }
+        return IndexSequence::build(sorted->size(), [&](size_t* out) {
+            for (size_t i = 0; i < sorted->size(); ++i) {
+                out[i] = position[(*sorted)[i]];
+            }
+        }, indexAllocator());
+    }
+
+    // Calls fn(const T* first, size_t n) for each contiguous stretch of elements, in
+    // insertion order (dead slots of deferred removals are skipped).
+    template<typename Fn>
+    void forEachSpan(Fn fn) const {
+        forEachLiveSpan(data(), fn);
+    }
+
+    // Counters of this container (all zero unless built with -DMYCONTAINER_STATS).
+    ContainerStats stats() const noexcept {
+#ifdef MYCONTAINER_STATS
+        return counters.snapshot();
+#else
+        return ContainerStats();
+#endif
+    }
+
+    void resetStats() noexcept {
+        MYCONTAINER_STAT(counters.reset());
+    }
+
+    // Returns the current buffer version, shared with the caller (O(1), no copy).
+    // While removal is deferred it still holds the dead slots; call compact() first.
+    std::shared_ptr<const Storage> snapshot() const noexcept {
+        return elements;
+    }
+
+    // Prints the container in a human-readable format: [a, b, c]. Numbers are formatted
+    // in bulk (see io/Format.hpp); io::print() prints any traversal order the same way.
+    friend std::ostream& operator<<(std::ostream& os, const MyContainer& cont) {
+        io::BulkWriter out(os);
+        out.text("[", 1);
+        bool separate = false;
+        cont.forEachSpan([&](const T* first, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                if (separate) {
+                    out.text(", ", 2);
+                }
+                out.value(first[i]);
+                separate = true;
+            }
+        });
+        out.text("]", 1);
         return os;
     }
 
@@ -134,6 +715,71 @@ public:
 
     MiddleOutOrder beginMiddleOutOrder() const;
     MiddleOutOrder endMiddleOutOrder()   const;
+
+    /**
+     * Calls fn(element) for every element from `from` to the end of its traversal order,
+     * splitting the sequence into chunks run on the shared work-stealing pool.
+     * Elements within a chunk are visited in traversal order; chunks run concurrently.
+     * @param from Any iterator of this container (e.g. beginSideCrossOrder()).
+     * @param grain Elements per chunk (0 = choose automatically).
+     * @throws std::runtime_error if from belongs to another container.
+     */
+    template<typename Iterator, typename Fn>
+    void parallel_for_each(const Iterator& from, Fn fn, size_t grain = 0) const;
+
+    /**
+     * Ordered reduction over the same range: each chunk folds its elements with
+     * acc = accumulate(acc, element) starting from init, then chunk results are folded
+     * with combine(left, right) strictly in traversal order. init must be an identity
+     * for combine; combine must be associative but need not be commutative.
+     */
+    template<typename Iterator, typename R, typename Accumulate, typename Combine>
+    R parallel_reduce(const Iterator& from, R init, Accumulate accumulate,
+                      Combine combine, size_t grain = 0) const;
+
+private:
+    // Splits [first, last) of an iterator's sequence into chunks for the pool.
+    static size_t chunkCount(size_t length, size_t& grain);
+
+    // Moves run boundaries to where they land once every `value` is erased.
+    void shrinkRuns(const Storage& elems, const T& value);
+
+    // Deferred remove(): marks every live slot equal to value as dead.
+    void removeDeferred(const T& value);
+
+    // Rescans the tracked extremes when value was one of them.
+    void rescanExtremaAfterRemoving(const T& value) {
+        if (extrema && (value == extrema->first || value == extrema->second)) {
+            extrema.reset();
+            if (size() > 0) {
+                extrema = scanMinmax(data());
+            }
+        }
+    }
+
+    // Number of elements == value in [from, to), vectorized per contiguous span.
+    static size_t countIn(const Storage& elems, size_t from, size_t to, const T& value) {
+        size_t total = 0;
+        storage::forEachSpan(elems, from, to, [&](const T* first, size_t n) {
+            total += simd::count(first, n, value);
+        });
+        return total;
+    }
+
+    // Smallest and largest live element of a non-empty buffer, one pass per span.
+    std::pair<T, T> scanMinmax(const Storage& elems) const {
+        std::optional<std::pair<T, T>> result;
+        forEachLiveSpan(elems, [&](const T* first, size_t n) {
+            std::pair<T, T> span = simd::minmax(first, n);
+            if (!result) {
+                result = span;
+                return;
+            }
+            if (span.first < result->first) result->first = span.first;
+            if (result->second < span.second) result->second = span.second;
+        });
+        return *result;
+    }
 };
 
 } // namespace container
@@ -147,71 +793,294 @@ public:
 #include "iterators/ReverseOrder.hpp"
 #include "iterators/SideCrossOrder.hpp"
 #include "iterators/MiddleOutOrder.hpp"
+#include "parallel/WorkStealingPool.hpp"
+#include "parallel/MultiwayMerge.hpp"
 
 namespace container {
 
 // Implementations of the iterator factory methods:
 
-template<typename T>
-typename MyContainer<T>::Order MyContainer<T>::beginOrder() const {
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::Order MyContainer<T, Alloc, Policy>::beginOrder() const {
     return Order(this, 0);
 }
 
-template<typename T>
-typename MyContainer<T>::Order MyContainer<T>::endOrder() const {
-    return Order(this, elements.size());
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::Order MyContainer<T, Alloc, Policy>::endOrder() const {
+    return Order(this, size());
 }
 
-template<typename T>
-typename MyContainer<T>::AscendingOrder MyContainer<T>::beginAscendingOrder() const {
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::AscendingOrder MyContainer<T, Alloc, Policy>::beginAscendingOrder() const {
     return AscendingOrder(this, 0);
 }
 
-template<typename T>
-typename MyContainer<T>::AscendingOrder MyContainer<T>::endAscendingOrder() const {
-    return AscendingOrder(this, elements.size());
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::AscendingOrder MyContainer<T, Alloc, Policy>::endAscendingOrder() const {
+    return AscendingOrder(this, size());
 }
 
-template<typename T>
-typename MyContainer<T>::DescendingOrder MyContainer<T>::beginDescendingOrder() const {
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::DescendingOrder MyContainer<T, Alloc, Policy>::beginDescendingOrder() const {
     return DescendingOrder(this, 0);
 }
 
-template<typename T>
-typename MyContainer<T>::DescendingOrder MyContainer<T>::endDescendingOrder() const {
-    return DescendingOrder(this, elements.size());
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::DescendingOrder MyContainer<T, Alloc, Policy>::endDescendingOrder() const {
+    return DescendingOrder(this, size());
 }
 
-template<typename T>
-typename MyContainer<T>::ReverseOrder MyContainer<T>::beginReverseOrder() const {
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::ReverseOrder MyContainer<T, Alloc, Policy>::beginReverseOrder() const {
     return ReverseOrder(this, 0);
 }
 
-template<typename T>
-typename MyContainer<T>::ReverseOrder MyContainer<T>::endReverseOrder() const {
-    return ReverseOrder(this, elements.size());
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::ReverseOrder MyContainer<T, Alloc, Policy>::endReverseOrder() const {
+    return ReverseOrder(this, size());
 }
 
-template<typename T>
-typename MyContainer<T>::SideCrossOrder MyContainer<T>::beginSideCrossOrder() const {
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::SideCrossOrder MyContainer<T, Alloc, Policy>::beginSideCrossOrder() const {
     return SideCrossOrder(this, 0);
 }
 
-template<typename T>
-typename MyContainer<T>::SideCrossOrder MyContainer<T>::endSideCrossOrder() const {
-    return SideCrossOrder(this, elements.size());
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::SideCrossOrder MyContainer<T, Alloc, Policy>::endSideCrossOrder() const {
+    return SideCrossOrder(this, size());
 }
 
-template<typename T>
-typename MyContainer<T>::MiddleOutOrder MyContainer<T>::beginMiddleOutOrder() const {
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::MiddleOutOrder MyContainer<T, Alloc, Policy>::beginMiddleOutOrder() const {
     return MiddleOutOrder(this, 0);
 }
 
-template<typename T>
-typename MyContainer<T>::MiddleOutOrder MyContainer<T>::endMiddleOutOrder() const {
-    return MiddleOutOrder(this, elements.size());
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::MiddleOutOrder MyContainer<T, Alloc, Policy>::endMiddleOutOrder() const {
+    return MiddleOutOrder(this, size());
+}
+
+template<typename T, typename Alloc, typename Policy>
+std::shared_ptr<const IndexSequence> MyContainer<T, Alloc, Policy>::sortedIndices() const {
+    auto cached = std::atomic_load(&sortedCache);
+    if (!cached) {
+        MYCONTAINER_STAT(auto start = std::chrono::steady_clock::now());
+        auto sorted = detail::allocateShared<IndexVector>(indexAllocator(), buildSortedIndices(data()));
+        cached = std::allocate_shared<IndexSequence>(indexAllocator(), std::shared_ptr<const IndexVector>(sorted));
+        std::atomic_store(&sortedCache, cached);
+        MYCONTAINER_STAT(counters.add(counters.permutationBuilds);
+                         counters.add(counters.sortNanoseconds, elapsedNanoseconds(start));)
+    } else {
+        MYCONTAINER_STAT(counters.add(counters.permutationCacheHits));
+    }
+    return cached;
+}
+
+template<typename T, typename Alloc, typename Policy>
+IndexSequence MyContainer<T, Alloc, Policy>::ascendingSequence() const {
+    const Storage& elems = data();
+    size_t n = size();
+    if (n > IndexSequence::InlineCapacity) {
+        return *sortedIndices();
+    }
+    if (auto cached = std::atomic_load(&sortedCache)) {
+        MYCONTAINER_STAT(counters.add(counters.permutationCacheHits));
+        return IndexSequence::build(n, [&](size_t* seq) {
+            std::copy(cached->data(), cached->data() + n, seq);
+        }, sequenceAllocator());
+    }
+    MYCONTAINER_STAT(counters.add(counters.permutationBuilds);
+                     auto start = std::chrono::steady_clock::now());
+    // Stable insertion sort: equal elements keep insertion order, as the merge of runs does
+    IndexSequence sorted = IndexSequence::build(n, [&](size_t* seq) {
+        size_t filled = 0;
+        for (size_t slot = 0; filled < n; ++slot) {
+            if (isDead(slot)) continue;
+            size_t j = filled++;
+            while (j > 0 && elems[slot] < elems[seq[j - 1]]) {
+                seq[j] = seq[j - 1];
+                --j;
+            }
+            seq[j] = slot;
+        }
+    }, sequenceAllocator());
+    MYCONTAINER_STAT(counters.add(counters.sortNanoseconds, elapsedNanoseconds(start)));
+    return sorted;
+}
+
+template<typename T, typename Alloc, typename Policy>
+typename MyContainer<T, Alloc, Policy>::IndexVector MyContainer<T, Alloc, Policy>::buildSortedIndices(const Storage& elems) const {
+    size_t n = elems.size() - deadCount;
+    IndexVector seq(n, indexAllocator());
+    if (deadCount == 0) {
+        std::iota(seq.begin(), seq.end(), size_t(0));
+    } else {
+        size_t filled = 0;
+        for (size_t slot = 0; filled < n; ++slot) {
+            if (!isDead(slot)) seq[filled++] = slot;
+        }
+    }
+    auto less = [&](size_t a, size_t b) {
+        return elems[a] < elems[b];
+    };
+    if (runs.empty()) {
+        sortIndexRange(seq.data(), seq.data() + n, elems);
+        return seq;
+    }
+
+    // Sort the unsorted segments in place, then merge all segments as index runs
+    std::vector<parallel::IndexRun, decltype(sequenceAllocator<parallel::IndexRun>())> indexRuns(
+        sequenceAllocator<parallel::IndexRun>());
+    indexRuns.reserve(runs.size() + 1);
+    size_t begin = 0;
+    auto addSegment = [&](size_t end, bool sorted) {
+        if (!sorted) {
+            sortIndexRange(seq.data() + begin, seq.data() + end, elems);
+        }
+        indexRuns.emplace_back(seq.data() + begin, seq.data() + end);
+        begin = end;
+    };
+    for (const Run& run : runs) {
+        addSegment(deadCount == 0 ? run.end : liveBefore(run.end), run.sorted);
+    }
+    if (begin < n) {
+        addSegment(n, false);
+    }
+
+    IndexVector merged(n, indexAllocator());
+    parallel::parallelMultiwayMerge(indexRuns, merged.data(), less);
+    return merged;
 }
 
+template<typename T, typename Alloc, typename Policy>
+void MyContainer<T, Alloc, Policy>::sortIndexRange(size_t* first, size_t* last, const Storage& elems) const {
+    if constexpr (std::is_arithmetic_v<T> && Policy::contiguous) {
+        size_t n = static_cast<size_t>(last - first);
+        if (simd::useSortingNetwork<T>(n)) {
+            simd::sortIndicesSmall(elems.data(), first, last);
+            return;
+        }
+        if (simd::useNetworkLeaves<T>(n) && elems.size() <= UINT32_MAX) {  // Indices packed in 32 bits
+            std::vector<size_t, decltype(sequenceAllocator())> scratch(n, sequenceAllocator());
+            simd::sortIndicesLeaves(elems.data(), first, last, scratch.data());
+            return;
+        }
+    }
+    std::sort(first, last, [&](size_t a, size_t b) {
+        return elems[a] < elems[b];
+    });
+}
+
+template<typename T, typename Alloc, typename Policy>
+void MyContainer<T, Alloc, Policy>::shrinkRuns(const Storage& elems, const T& value) {
+    std::vector<Run, Rebind<Run>> kept{Rebind<Run>(alloc)};
+    size_t begin = 0;
+    size_t removed = 0;
+    for (const Run& run : runs) {
+        removed += countIn(elems, begin, run.end, value);
+        size_t newEnd = run.end - removed;
+        if (newEnd > (kept.empty() ? 0 : kept.back().end)) {
+            kept.push_back(Run{newEnd, run.sorted});
+        }
+        begin = run.end;
+    }
+    runs.swap(kept);
+}
+
+template<typename T, typename Alloc, typename Policy>
+void MyContainer<T, Alloc, Policy>::removeDeferred(const T& value) {
+    const Storage& elems = data();
+    size_t slots = elems.size();
+    size_t before = deadCount;
+    for (size_t slot = 0; slot < slots; ++slot) {
+        if (!isDead(slot) && elems[slot] == value) {
+            markDead(slot);
+        }
+    }
+    if (deadCount == before) {
+        throw std::runtime_error("Element not found in container");
+    }
+    MYCONTAINER_STAT(counters.add(counters.removes));
+    // The buffer is untouched; only the permutation is stale
+    std::atomic_store(&sortedCache, std::shared_ptr<const IndexSequence>());
+    if (static_cast<double>(deadCount) > compactRatio * static_cast<double>(slots)) {
+        compact();
+    }
+    rescanExtremaAfterRemoving(value);
+}
+
+template<typename T, typename Alloc, typename Policy>
+size_t MyContainer<T, Alloc, Policy>::chunkCount(size_t length, size_t& grain) {
+    if (grain == 0) {
+        // Roughly 8 chunks per participant leaves room for stealing, but never tiny chunks
+        size_t target = parallel::WorkStealingPool::shared().participants() * 8;
+        grain = std::max<size_t>(1024, (length + target - 1) / target);
+    }
+    return (length + grain - 1) / grain;
+}
+
+template<typename T, typename Alloc, typename Policy>
+template<typename Iterator, typename Fn>
+void MyContainer<T, Alloc, Policy>::parallel_for_each(const Iterator& from, Fn fn, size_t grain) const {
+    if (from.containerPtr != this) {
+        throw std::runtime_error("Iterator belongs to a different container");
+    }
+    const IndexSequence& seq = from.orderIndices;
+    size_t first = std::min(from.index, seq.size());
+    size_t length = seq.size() - first;
+    if (length == 0) return;
+    const Storage& elems = *from.snapshot;
+
+    size_t chunks = chunkCount(length, grain);
+    parallel::WorkStealingPool::shared().run(chunks, [&](size_t c) {
+        size_t begin = first + c * grain;
+        size_t end = std::min(begin + grain, seq.size());
+        for (size_t i = begin; i < end; ++i) {
+            fn(elems[seq[i]]);
+        }
+    });
+}
+
+template<typename T, typename Alloc, typename Policy>
+template<typename Iterator, typename R, typename Accumulate, typename Combine>
+R MyContainer<T, Alloc, Policy>::parallel_reduce(const Iterator& from, R init, Accumulate accumulate,
+                                  Combine combine, size_t grain) const {
+    if (from.containerPtr != this) {
+        throw std::runtime_error("Iterator belongs to a different container");
+    }
+    const IndexSequence& seq = from.orderIndices;
+    size_t first = std::min(from.index, seq.size());
+    size_t length = seq.size() - first;
+    if (length == 0) return init;
+    const Storage& elems = *from.snapshot;
+
+    size_t chunks = chunkCount(length, grain);
+    std::vector<R, decltype(sequenceAllocator<R>())> partial(chunks, init, sequenceAllocator<R>());
+    parallel::WorkStealingPool::shared().run(chunks, [&](size_t c) {
+        size_t begin = first + c * grain;
+        size_t end = std::min(begin + grain, seq.size());
+        R acc = init;
+        for (size_t i = begin; i < end; ++i) {
+            acc = accumulate(std::move(acc), elems[seq[i]]);
+        }
+        partial[c] = std::move(acc);
+    });
+
+    R result = std::move(partial[0]);
+    for (size_t c = 1; c < chunks; ++c) {
+        result = combine(std::move(result), std::move(partial[c]));
+    }
+    return result;
+}
+
+namespace pmr {
+
+// MyContainer whose buffers come from a std::pmr::memory_resource.
+template<typename T, typename Policy = ContiguousStorage>
+using MyContainer = container::MyContainer<T, std::pmr::polymorphic_allocator<T>, Policy>;
+
+} // namespace pmr
+
 } // namespace container
 
 #endif // MYCONTAINER_HPP
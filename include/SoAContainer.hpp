@@ -0,0 +1,328 @@
+// eitan.derdiger@gmail.com
+
+#ifndef SOACONTAINER_HPP
+#define SOACONTAINER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "iterators/IndexSequence.hpp"
+#include "iterators/OrderSequences.hpp"
+#include "iterators/ScratchArena.hpp"
+
+/*
+  SoAContainer<T, Key, Fields...> stores aggregate records column by column
+  (structure of arrays) instead of as whole records.
+
+  Usage:
+      struct Trade { double price; long id; int qty; };
+      SoAContainer<Trade, &Trade::price, &Trade::id, &Trade::qty> trades;
+
+    - The template arguments after T are pointers to the data members to store; each
+      becomes its own contiguous std::vector. The first one (Key) is the sort key.
+    - T must be default constructible; at(i) and record traversals rebuild a T from
+      the listed members (members not listed keep their default value).
+
+  Traversals:
+    - records(Traversal::X) visits whole records (rebuilt T values) in one of the six
+      orders of MyContainer: Order, Ascending, Descending, Reverse, SideCross,
+      MiddleOut. The value orders compare Key only.
+    - field<&T::member>(Traversal::X) visits a single column in that order, touching
+      no other column.
+    - The ascending permutation sorts (key, index) pairs copied from the key column, so
+      a sort streams over one column instead of pulling whole records through cache.
+      It is cached until the next add() or remove().
+
+  Notes:
+    - Views (and their iterators) refer to the container; like std::vector
+      iterators, they are invalidated by add() and remove().
+    - Const member functions may run concurrently; mutations need exclusive access.
+*/
+
+namespace container {
+
+namespace detail {
+
+template<auto Member>
+struct MemberOf;
+
+template<typename C, typename F, F C::*Member>
+struct MemberOf<Member> {
+    using Class = C;
+    using Type = F;
+};
+
+// Position of member pointer M among Fields (sizeof...(Fields) if absent).
+template<auto M, auto First, auto... Rest>
+constexpr size_t memberIndex() {
+    if constexpr (std::is_same_v<decltype(M), decltype(First)>) {
+        if (M == First) return 0;
+    }
+    if constexpr (sizeof...(Rest) == 0) {
+        return 1;
+    } else {
+        return 1 + memberIndex<M, Rest...>();
+    }
+}
+
+} // namespace detail
+
+template<typename T, auto Key, auto... Fields>
+class SoAContainer {
+    static_assert(std::is_default_constructible_v<T>, "T must be default constructible");
+    static_assert((std::is_same_v<typename detail::MemberOf<Key>::Class, T> && ... &&
+                   std::is_same_v<typename detail::MemberOf<Fields>::Class, T>),
+                  "Key and Fields must be data members of T");
+
+    static constexpr size_t FieldCount = 1 + sizeof...(Fields);
+
+    template<auto Member>
+    using Column = std::vector<typename detail::MemberOf<Member>::Type>;
+
+public:
+    using KeyType = typename detail::MemberOf<Key>::Type;
+
+    // Range over one traversal order; Project maps an element index to the visited value.
+    template<typename Project>
+    class View {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = std::decay_t<decltype(std::declval<Project>()(size_t(0)))>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = decltype(std::declval<Project>()(size_t(0)));
+
+            iterator(const size_t* pos, const Project* project) : pos(pos), project(project) {}
+
+            reference operator*() const { return (*project)(*pos); }
+            iterator& operator++() { ++pos; return *this; }
+            iterator operator++(int) { iterator tmp = *this; ++pos; return tmp; }
+            bool operator==(const iterator& other) const { return pos == other.pos; }
+            bool operator!=(const iterator& other) const { return pos != other.pos; }
+
+        private:
+            const size_t* pos;
+            const Project* project;
+        };
+
+        View(IndexSequence seq, Project project) : seq(std::move(seq)), project(std::move(project)) {}
+
+        iterator begin() const { return iterator(seq.data(), &project); }
+        iterator end() const { return iterator(seq.data() + seq.size(), &project); }
+        size_t size() const noexcept { return seq.size(); }
+
+    private:
+        IndexSequence seq;
+        Project project;
+    };
+
+    SoAContainer() = default;
+
+    SoAContainer(const SoAContainer& other)
+        : columns(other.columns), sortedCache(std::atomic_load(&other.sortedCache)) {}
+
+    SoAContainer& operator=(const SoAContainer& other) {
+        if (this != &other) {
+            columns = other.columns;
+            std::atomic_store(&sortedCache, std::atomic_load(&other.sortedCache));
+        }
+        return *this;
+    }
+
+    // Appends a record, one value per column.
+    void add(const T& value) {
+        invalidate();
+        forEachColumn([&](auto& column, auto member) {
+            column.push_back(value.*decltype(member)::value);
+        });
+    }
+
+    void reserve(size_t capacity) {
+        forEachColumn([&](auto& column, auto) { column.reserve(capacity); });
+    }
+
+    /**
+     * Removes every record whose stored members all equal those of value. The key column
+     * is compared first, so the other columns are read only for key matches.
+     * @throws std::runtime_error if no record matches.
+     */
+    void remove(const T& value) {
+        size_t n = size();
+        std::vector<bool> drop(n, false);
+        size_t matches = 0;
+        const Column<Key>& keys = keyColumn();
+        for (size_t i = 0; i < n; ++i) {
+            if (keys[i] == value.*Key && matchesAt(i, value)) {
+                drop[i] = true;
+                ++matches;
+            }
+        }
+        if (matches == 0) {
+            throw std::runtime_error("Element not found in container");
+        }
+        invalidate();
+        forEachColumn([&](auto& column, auto) {
+            size_t kept = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (!drop[i]) {
+                    if (kept != i) {
+                        column[kept] = std::move(column[i]);
+                    }
+                    ++kept;
+                }
+            }
+            column.resize(kept);
+        });
+    }
+
+    size_t size() const noexcept {
+        return keyColumn().size();
+    }
+
+    // Rebuilds record i from its columns.
+    T at(size_t i) const {
+        if (i >= size()) {
+            throw std::runtime_error("Index out of range");
+        }
+        return record(i);
+    }
+
+    // The contiguous column holding Member (one of Key, Fields...).
+    template<auto Member>
+    const Column<Member>& column() const noexcept {
+        constexpr size_t index = detail::memberIndex<Member, Key, Fields...>();
+        static_assert(index < FieldCount, "Member is not stored by this container");
+        return std::get<index>(columns);
+    }
+
+    // Whole records in the given order.
+    auto records(Traversal order) const {
+        auto project = [this](size_t i) { return record(i); };
+        return View<decltype(project)>(sequence(order), project);
+    }
+
+    // One column in the given order.
+    template<auto Member>
+    auto field(Traversal order) const {
+        const Column<Member>* col = &column<Member>();
+        auto project = [col](size_t i) -> const typename detail::MemberOf<Member>::Type& {
+            return (*col)[i];
+        };
+        return View<decltype(project)>(sequence(order), project);
+    }
+
+private:
+    std::tuple<Column<Key>, Column<Fields>...> columns;
+
+    // Ascending permutation by Key (null until first needed); atomic_load / atomic_store only.
+    mutable std::shared_ptr<const std::vector<size_t>> sortedCache;
+
+    const Column<Key>& keyColumn() const noexcept {
+        return std::get<0>(columns);
+    }
+
+    void invalidate() {
+        std::atomic_store(&sortedCache, std::shared_ptr<const std::vector<size_t>>());
+    }
+
+    // Calls fn(column, std::integral_constant<member pointer>) for every column.
+    template<typename Fn>
+    void forEachColumn(Fn fn) {
+        forEachColumnImpl(fn, std::make_index_sequence<FieldCount>());
+    }
+
+    template<typename Fn, size_t... I>
+    void forEachColumnImpl(Fn& fn, std::index_sequence<I...>) {
+        constexpr auto members = std::make_tuple(Key, Fields...);
+        (fn(std::get<I>(columns),
+            std::integral_constant<std::tuple_element_t<I, decltype(members)>, std::get<I>(members)>()),
+         ...);
+    }
+
+    T record(size_t i) const {
+        return recordImpl(i, std::make_index_sequence<FieldCount>());
+    }
+
+    template<size_t... I>
+    T recordImpl(size_t i, std::index_sequence<I...>) const {
+        constexpr auto members = std::make_tuple(Key, Fields...);
+        T out{};
+        ((out.*std::get<I>(members) = std::get<I>(columns)[i]), ...);
+        return out;
+    }
+
+    bool matchesAt(size_t i, const T& value) const {
+        return matchesAtImpl(i, value, std::make_index_sequence<FieldCount>());
+    }
+
+    template<size_t... I>
+    bool matchesAtImpl(size_t i, const T& value, std::index_sequence<I...>) const {
+        constexpr auto members = std::make_tuple(Key, Fields...);
+        return ((std::get<I>(columns)[i] == value.*std::get<I>(members)) && ...);
+    }
+
+    // Ascending permutation by Key: sorts (key, index) pairs, so ties keep index order.
+    std::shared_ptr<const std::vector<size_t>> sortedIndices() const {
+        auto cached = std::atomic_load(&sortedCache);
+        if (cached) return cached;
+
+        const Column<Key>& keys = keyColumn();
+        size_t n = keys.size();
+        std::vector<std::pair<KeyType, size_t>> pairs(n);
+        for (size_t i = 0; i < n; ++i) {
+            pairs[i] = {keys[i], i};
+        }
+        std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) {
+            if (a.first < b.first) return true;
+            if (b.first < a.first) return false;
+            return a.second < b.second;
+        });
+        auto seq = std::make_shared<std::vector<size_t>>(n);
+        for (size_t i = 0; i < n; ++i) {
+            (*seq)[i] = pairs[i].second;
+        }
+        cached = std::move(seq);
+        std::atomic_store(&sortedCache, cached);
+        return cached;
+    }
+
+    IndexSequence sequence(Traversal order) const {
+        size_t n = size();
+        ScratchAllocator<size_t> scratch;
+        switch (order) {
+            case Traversal::Ascending:
+                return IndexSequence(sortedIndices());
+            case Traversal::Descending: {
+                auto asc = sortedIndices();
+                return IndexSequence::build(n, [&](size_t* out) {
+                    orders::descending(asc->data(), n, out);
+                }, scratch);
+            }
+            case Traversal::SideCross: {
+                auto asc = sortedIndices();
+                return IndexSequence::build(n, [&](size_t* out) {
+                    orders::sideCross(asc->data(), n, out);
+                }, scratch);
+            }
+            case Traversal::Reverse:
+                return IndexSequence::build(n, [n](size_t* out) { orders::reverse(n, out); }, scratch);
+            case Traversal::MiddleOut:
+                return IndexSequence::build(n, [n](size_t* out) { orders::middleOut(n, out); }, scratch);
+            case Traversal::Order:
+            default:
+                return IndexSequence::build(n, [n](size_t* out) { orders::insertion(n, out); }, scratch);
+        }
+    }
+};
+
+} // namespace container
+
+#endif // SOACONTAINER_HPP
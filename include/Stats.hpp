@@ -0,0 +1,147 @@
+// eitan.derdiger@gmail.com
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "iterators/OrderSequences.hpp"
+
+/*
+  Stats.hpp holds the hot-path counters of MyContainer, compiled in only when
+  MYCONTAINER_STATS is defined (e.g. -DMYCONTAINER_STATS).
+
+    - MYCONTAINER_STAT(statement) expands to statement when enabled and to nothing
+      otherwise, so a regular build carries no counters, no timing and no extra members.
+    - ContainerStats is a plain snapshot of one container's counters, returned by
+      MyContainer::stats() (all zero, with enabled == false, in a regular build);
+      toJson() renders it as one JSON object.
+    - detail::StatCounters holds the live counters as relaxed atomics, since const
+      members (iterator construction, the permutation cache) may run concurrently.
+
+  Counters:
+    - sequences[order]:     index sequences built by iterator constructors, per order
+                            (end iterators build none).
+    - sequenceBytes:        heap bytes allocated for those sequences (inline ones and
+                            AscendingOrder's shared permutation cost none).
+    - permutationBuilds:    ascending permutations computed (sort or merge of runs);
+                            each one is a miss of the permutation cache.
+    - permutationCacheHits: sorted-order requests served by the cached permutation.
+    - sortNanoseconds:      time spent in those permutation builds.
+    - removes:              remove() calls that found the value.
+    - elementsShifted:      elements moved to close gaps, by remove() and compact().
+    - compactions:          compact() passes over dead slots.
+*/
+
+#ifdef MYCONTAINER_STATS
+#define MYCONTAINER_STAT(...) __VA_ARGS__
+#else
+#define MYCONTAINER_STAT(...)
+#endif
+
+namespace container {
+
+struct ContainerStats {
+    static constexpr size_t OrderCount = 6;
+
+    bool enabled = false;
+    std::array<uint64_t, OrderCount> sequences{};  // Indexed by Traversal
+    uint64_t sequenceBytes = 0;
+    uint64_t permutationBuilds = 0;
+    uint64_t permutationCacheHits = 0;
+    uint64_t sortNanoseconds = 0;
+    uint64_t removes = 0;
+    uint64_t elementsShifted = 0;
+    uint64_t compactions = 0;
+
+    uint64_t sequencesOf(Traversal order) const noexcept {
+        return sequences[static_cast<size_t>(order)];
+    }
+
+    std::string toJson() const {
+        static const char* const names[OrderCount] = {
+            "order", "ascending", "descending", "reverse", "sideCross", "middleOut"};
+        std::string out = "{\"enabled\": ";
+        out += enabled ? "true" : "false";
+        out += ", \"sequences\": {";
+        for (size_t i = 0; i < OrderCount; ++i) {
+            out += i ? ", \"" : "\"";
+            out += names[i];
+            out += "\": " + std::to_string(sequences[i]);
+        }
+        out += "}";
+        auto field = [&out](const char* name, uint64_t value) {
+            out += ", \"";
+            out += name;
+            out += "\": " + std::to_string(value);
+        };
+        field("sequenceBytes", sequenceBytes);
+        field("permutationBuilds", permutationBuilds);
+        field("permutationCacheHits", permutationCacheHits);
+        field("sortNanoseconds", sortNanoseconds);
+        field("removes", removes);
+        field("elementsShifted", elementsShifted);
+        field("compactions", compactions);
+        out += "}";
+        return out;
+    }
+};
+
+namespace detail {
+
+class StatCounters {
+public:
+    StatCounters() = default;
+    StatCounters(const StatCounters&) : StatCounters() {}  // Copies start counting afresh
+    StatCounters& operator=(const StatCounters&) { return *this; }
+
+    void add(std::atomic<uint64_t>& counter, uint64_t amount = 1) noexcept {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void sequence(Traversal order, uint64_t heapBytes) noexcept {
+        add(sequences[static_cast<size_t>(order)]);
+        add(sequenceBytes, heapBytes);
+    }
+
+    ContainerStats snapshot() const noexcept {
+        ContainerStats s;
+        s.enabled = true;
+        for (size_t i = 0; i < ContainerStats::OrderCount; ++i) {
+            s.sequences[i] = sequences[i].load(std::memory_order_relaxed);
+        }
+        s.sequenceBytes = sequenceBytes.load(std::memory_order_relaxed);
+        s.permutationBuilds = permutationBuilds.load(std::memory_order_relaxed);
+        s.permutationCacheHits = permutationCacheHits.load(std::memory_order_relaxed);
+        s.sortNanoseconds = sortNanoseconds.load(std::memory_order_relaxed);
+        s.removes = removes.load(std::memory_order_relaxed);
+        s.elementsShifted = elementsShifted.load(std::memory_order_relaxed);
+        s.compactions = compactions.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset() noexcept {
+        for (auto& c : sequences) c.store(0, std::memory_order_relaxed);
+        for (auto* c : {&sequenceBytes, &permutationBuilds, &permutationCacheHits, &sortNanoseconds,
+                        &removes, &elementsShifted, &compactions}) {
+            c->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::array<std::atomic<uint64_t>, ContainerStats::OrderCount> sequences{};
+    std::atomic<uint64_t> sequenceBytes{0};
+    std::atomic<uint64_t> permutationBuilds{0};
+    std::atomic<uint64_t> permutationCacheHits{0};
+    std::atomic<uint64_t> sortNanoseconds{0};
+    std::atomic<uint64_t> removes{0};
+    std::atomic<uint64_t> elementsShifted{0};
+    std::atomic<uint64_t> compactions{0};
+};
+
+} // namespace detail
+
+} // namespace container
+
+#endif // STATS_HPP
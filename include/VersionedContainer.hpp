@@ -0,0 +1,176 @@
+// eitan.derdiger@gmail.com
+
+#ifndef VERSIONEDCONTAINER_HPP
+#define VERSIONEDCONTAINER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "MyContainer.hpp"
+
+/*
+  VersionedContainer<T> lets reader threads traverse a MyContainer while a writer
+  keeps calling add()/remove().
+
+  Model (append-only log with a published length):
+    - Elements live in an AppendLog<T> (see storage/AppendLog.hpp): chunks that never
+      move, plus an atomically published length.
+    - Every write builds one immutable Snapshot, a MyContainer<T, std::allocator<T>,
+      PrefixStorage> over the log's current prefix, and publishes it. Readers use any of
+      the six iterator orders on it without locks and never observe later writes; its
+      sorted permutation is built once and shared by every reader of that version.
+    - add() appends to the log and publishes a snapshot of the longer prefix: amortized
+      O(1), the log is never copied.
+    - remove() and update() copy the live elements into a fresh log (O(n)) and publish
+      a snapshot of it; snapshots of the old log keep it alive until they are dropped.
+
+  Publication (Left-Right, Ramalhete and Correia):
+    - The latest version sits in two slots. Readers copy the slot named by `front`
+      while counted in one of two read indicators, so snapshot() is wait-free: two
+      atomic counter updates and one shared_ptr copy, with no lock and no allocation.
+    - The writer fills the other slot, flips `front`, then waits until both indicators
+      have drained before it overwrites (and so releases) the old version.
+
+  Notes:
+    - Writers are serialized by an internal mutex; readers never take it.
+    - A writer waits only for readers that are inside snapshot() or size(), never for
+      readers that are traversing a version they hold.
+*/
+
+namespace container {
+
+template<typename T>
+class VersionedContainer {
+public:
+    using Log = AppendLog<T>;
+    using Snapshot = MyContainer<T, std::allocator<T>, PrefixStorage>;
+    using Version = std::shared_ptr<const Snapshot>;
+
+    VersionedContainer() : current(std::make_shared<Log>()) {
+        slots[0] = slots[1] = versionOf(current, 0);
+    }
+
+    VersionedContainer(const VersionedContainer&) = delete;
+    VersionedContainer& operator=(const VersionedContainer&) = delete;
+    ~VersionedContainer() = default;
+
+    // Returns the latest published version (wait-free); it stays valid for as long as
+    // it is held.
+    Version snapshot() const {
+        return read([](const Version& v) { return v; });
+    }
+
+    // Number of versions published so far (0 for the initial empty version).
+    std::uint64_t version() const noexcept {
+        return publishCount.load(std::memory_order_acquire);
+    }
+
+    // Number of elements in the latest version.
+    size_t size() const {
+        return read([](const Version& v) { return v->size(); });
+    }
+
+    // Appends a value and publishes it (amortized O(1): the log is never copied).
+    void add(const T& value) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        // Built first, so a failed allocation leaves the log and the readers untouched;
+        // the new element is not read before push_back() publishes it
+        Version next = versionOf(current, current->size() + 1);
+        current->push_back(value);
+        publish(std::move(next));
+    }
+
+    /**
+     * Removes all occurrences of value and publishes a new version (copies the log).
+     * @throws std::runtime_error if the element is not found (nothing is published).
+     */
+    void remove(const T& value) {
+        update([&](MyContainer<T>& next) { next.remove(value); });
+    }
+
+    /**
+     * Applies fn to a private copy of the latest version, then publishes the result as
+     * a new log (O(n)). If fn throws, the copy is discarded and readers keep the
+     * previous version.
+     */
+    template<typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        size_t n = current->size();
+        MyContainer<T> next;
+        next.reserve(n);
+        current->forEachSpan(0, n, [&](const T* first, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                next.add(first[i]);
+            }
+        });
+        std::forward<Fn>(fn)(next);
+
+        auto log = std::make_shared<Log>();
+        next.forEachSpan([&](const T* first, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                log->push_back(first[i]);
+            }
+        });
+        Version published = versionOf(log, log->size());
+        current = std::move(log);
+        publish(std::move(published));
+    }
+
+private:
+    // A read indicator on its own cache line, so readers of the two do not collide.
+    struct alignas(64) ReadIndicator {
+        std::atomic<size_t> readers{0};
+    };
+
+    std::shared_ptr<Log> current;  // Touched only by the writer, under writerMutex
+    Version slots[2];              // Both hold the latest version between writes
+    std::atomic<unsigned> front{0};
+    std::atomic<unsigned> readEpoch{0};
+    mutable ReadIndicator indicators[2];
+    std::atomic<std::uint64_t> publishCount{0};
+    std::mutex writerMutex;
+
+    static Version versionOf(std::shared_ptr<const Log> log, size_t n) {
+        return std::make_shared<const Snapshot>(std::make_shared<PrefixVector<T>>(std::move(log), n));
+    }
+
+    // Calls fn on the latest version while registered in the current read indicator.
+    template<typename Fn>
+    auto read(Fn fn) const {
+        ReadIndicator& indicator = indicators[readEpoch.load()];
+        indicator.readers.fetch_add(1);
+        struct Depart {
+            ReadIndicator& indicator;
+            ~Depart() { indicator.readers.fetch_sub(1); }
+        } depart{indicator};
+        return fn(slots[front.load()]);
+    }
+
+    // Publishes next: readers move to the other slot, then the old one is overwritten
+    // once no reader can still be copying it (writerMutex must be held).
+    void publish(Version next) noexcept {
+        unsigned back = 1 - front.load(std::memory_order_relaxed);
+        slots[back] = next;  // No reader is on the back slot: it was drained last time
+        front.store(back);
+        unsigned epoch = readEpoch.load(std::memory_order_relaxed);
+        waitUntilDrained(indicators[1 - epoch]);
+        readEpoch.store(1 - epoch);
+        waitUntilDrained(indicators[epoch]);
+        slots[1 - back] = std::move(next);  // Releases the previous version
+        publishCount.fetch_add(1, std::memory_order_release);
+    }
+
+    static void waitUntilDrained(const ReadIndicator& indicator) noexcept {
+        while (indicator.readers.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+} // namespace container
+
+#endif // VERSIONEDCONTAINER_HPP
@@ -0,0 +1,226 @@
+// eitan.derdiger@gmail.com
+
+#ifndef WINDOWEDCONTAINER_HPP
+#define WINDOWEDCONTAINER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "iterators/OrderSequences.hpp"
+
+/*
+  WindowedContainer<T> keeps the last `window` values of an unbounded stream in bounded
+  memory and offers the six traversal orders of MyContainer over them.
+
+  Usage:
+      WindowedContainer<double> last(1000);
+      for (double v : events) last.add(v);   // Keeps the newest 1000
+      for (auto it = last.beginSideCrossOrder(); it != last.endSideCrossOrder(); ++it) ...
+
+  How it works:
+    - Values live in a ring buffer of `window` slots; once it is full, add() overwrites
+      the oldest slot in O(1).
+    - A sorted copy of the window is updated by the same add(): the evicted value's
+      entry is found by binary search, and the entries between it and the new value's
+      place shift by one, so no query ever sorts.
+    - Every order is a formula over the ring or the sorted copy (SideCrossOrder takes
+      from both ends of it, MiddleOutOrder starts at the middle slot), so begin*()
+      allocates nothing and costs O(1).
+    - Order visits oldest to newest; min() and max() are O(1).
+
+  Notes:
+    - Iterators read the container live; like std::vector iterators, they are
+      invalidated by add().
+    - T must support operator<.
+*/
+
+namespace container {
+
+template<typename T>
+class WindowedContainer {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        Iterator() = default;
+
+        const T& operator*() const {
+            if (!cont || step >= cont->size()) {
+                throw std::runtime_error("Iterator out of range");
+            }
+            return cont->at(kind, step);
+        }
+
+        const T* operator->() const { return &**this; }
+
+        Iterator& operator++() {
+            if (!cont || step >= cont->size()) {
+                throw std::runtime_error("Increment past end");
+            }
+            ++step;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const Iterator& other) const { return cont == other.cont && step == other.step; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class WindowedContainer;
+
+        Iterator(const WindowedContainer* cont, Traversal kind, size_t step)
+            : cont(cont), kind(kind), step(step) {}
+
+        const WindowedContainer* cont = nullptr;
+        Traversal kind = Traversal::Order;
+        size_t step = 0;
+    };
+
+    using Order = Iterator;
+    using AscendingOrder = Iterator;
+    using DescendingOrder = Iterator;
+    using ReverseOrder = Iterator;
+    using SideCrossOrder = Iterator;
+    using MiddleOutOrder = Iterator;
+
+    /**
+     * @param window Number of most recent values kept.
+     * @throws std::runtime_error if window is 0.
+     */
+    explicit WindowedContainer(size_t window) : window(window) {
+        if (window == 0) {
+            throw std::runtime_error("Window size must be positive");
+        }
+    }
+
+    // Appends value, evicting the oldest value once the window is full.
+    void add(const T& value) {
+        if (ring.size() < window) {
+            if (ring.capacity() == 0) {
+                ring.reserve(window);
+                sorted.reserve(window);
+            }
+            ring.push_back(value);
+            sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), value), value);
+            return;
+        }
+
+        // Reuse the oldest value's sorted entry: shift the entries between it and the
+        // new value's place by one instead of an erase plus an insert
+        auto from = std::lower_bound(sorted.begin(), sorted.end(), ring[head]);
+        auto to = std::upper_bound(sorted.begin(), sorted.end(), value);
+        if (from < to) {
+            --to;
+            std::move(from + 1, to + 1, from);
+        } else {
+            std::move_backward(to, from, from + 1);
+        }
+        *to = value;
+
+        ring[head] = value;
+        head = head + 1 == window ? 0 : head + 1;
+    }
+
+    size_t size() const noexcept { return ring.size(); }
+    size_t windowSize() const noexcept { return window; }
+    bool full() const noexcept { return ring.size() == window; }
+
+    /**
+     * @throws std::runtime_error if the container is empty.
+     */
+    const T& min() const {
+        if (sorted.empty()) {
+            throw std::runtime_error("Container is empty");
+        }
+        return sorted.front();
+    }
+
+    /**
+     * @throws std::runtime_error if the container is empty.
+     */
+    const T& max() const {
+        if (sorted.empty()) {
+            throw std::runtime_error("Container is empty");
+        }
+        return sorted.back();
+    }
+
+    // Values in ascending order, as a contiguous range.
+    const std::vector<T>& ascending() const noexcept { return sorted; }
+
+    Iterator beginOrder() const { return Iterator(this, Traversal::Order, 0); }
+    Iterator endOrder() const { return Iterator(this, Traversal::Order, size()); }
+
+    Iterator beginAscendingOrder() const { return Iterator(this, Traversal::Ascending, 0); }
+    Iterator endAscendingOrder() const { return Iterator(this, Traversal::Ascending, size()); }
+
+    Iterator beginDescendingOrder() const { return Iterator(this, Traversal::Descending, 0); }
+    Iterator endDescendingOrder() const { return Iterator(this, Traversal::Descending, size()); }
+
+    Iterator beginReverseOrder() const { return Iterator(this, Traversal::Reverse, 0); }
+    Iterator endReverseOrder() const { return Iterator(this, Traversal::Reverse, size()); }
+
+    Iterator beginSideCrossOrder() const { return Iterator(this, Traversal::SideCross, 0); }
+    Iterator endSideCrossOrder() const { return Iterator(this, Traversal::SideCross, size()); }
+
+    Iterator beginMiddleOutOrder() const { return Iterator(this, Traversal::MiddleOut, 0); }
+    Iterator endMiddleOutOrder() const { return Iterator(this, Traversal::MiddleOut, size()); }
+
+    Iterator begin() const { return beginOrder(); }
+    Iterator end() const { return endOrder(); }
+
+private:
+    // The value visited at `step` of a traversal (step < size()).
+    const T& at(Traversal kind, size_t step) const {
+        size_t n = ring.size();
+        switch (kind) {
+        case Traversal::Ascending:
+            return sorted[step];
+        case Traversal::Descending:
+            return sorted[n - 1 - step];
+        case Traversal::SideCross:
+            return (step % 2 == 0) ? sorted[step / 2] : sorted[n - 1 - step / 2];
+        case Traversal::Reverse:
+            return slot(n - 1 - step);
+        case Traversal::MiddleOut: {
+            // mid, mid-1, mid+1, mid-2, ...; the right side is never shorter, so once
+            // the left side runs out the remaining steps are positions step, step+1, ...
+            size_t mid = (n - 1) / 2;
+            if (step == 0) return slot(mid);
+            if (step > 2 * mid) return slot(step);
+            return slot(step % 2 == 1 ? mid - (step + 1) / 2 : mid + step / 2);
+        }
+        case Traversal::Order:
+        default:
+            return slot(step);
+        }
+    }
+
+    // The value at insertion position i of the window (0 = oldest).
+    const T& slot(size_t i) const {
+        size_t p = head + i;
+        return ring[p >= window ? p - window : p];
+    }
+
+    size_t window;
+    std::vector<T> ring;
+    size_t head = 0;        // Slot of the oldest value once the ring is full
+    std::vector<T> sorted;  // The window's values in ascending order
+};
+
+} // namespace container
+
+#endif // WINDOWEDCONTAINER_HPP
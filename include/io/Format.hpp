@@ -0,0 +1,157 @@
+// eitan.derdiger@gmail.com
+
+#ifndef FORMAT_HPP
+#define FORMAT_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <locale>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include "../iterators/ScratchArena.hpp"
+
+/*
+  Format.hpp holds the bulk text formatter behind MyContainer's operator<< and
+  io::print().
+
+    - BulkWriter formats integers and floating-point values with std::to_chars into a
+      64 KiB block from the thread's ScratchArena and hands the stream one write()
+      per full block, instead of one formatted insertion per element and separator.
+    - The output is the same as inserting each value with operator<<: floating-point
+      values honour the stream's precision and fixed / scientific flags. Streams with
+      other formatting state (showpos, hex, a width, a non-classic locale, ...) and
+      non-numeric element types go through operator<< as before.
+    - io::print(os, first, last) writes "[a, b, c]" for any iterator range, e.g.
+      io::print(std::cout, c.beginSideCrossOrder(), c.endSideCrossOrder()).
+*/
+
+namespace container {
+namespace io {
+
+namespace detail {
+
+// Numeric types that to_chars formats exactly like operator<< does (char and bool
+// print as characters / 0-1 and keep the stream path).
+template<typename T>
+constexpr bool bulkFormattable =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+     !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char> &&
+     !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>) ||
+    std::is_floating_point_v<T>;
+
+} // namespace detail
+
+class BulkWriter {
+public:
+    static constexpr size_t BlockSize = size_t(1) << 16;
+
+    explicit BulkWriter(std::ostream& os)
+        : os(os), block(static_cast<char*>(ScratchArena::allocate(BlockSize))) {
+        std::ios_base::fmtflags flags = os.flags();
+        std::ios_base::fmtflags plain = std::ios_base::showpos | std::ios_base::showpoint |
+                                        std::ios_base::uppercase | std::ios_base::showbase;
+        std::ios_base::fmtflags base = flags & std::ios_base::basefield;
+        fast = !(flags & plain) && (base == std::ios_base::dec || base == std::ios_base::fmtflags()) &&
+               os.width() == 0 && os.getloc() == std::locale::classic();
+
+        std::ios_base::fmtflags field = flags & std::ios_base::floatfield;
+        if (field == std::ios_base::fixed) {
+            floatFormat = std::chars_format::fixed;
+        } else if (field == std::ios_base::scientific) {
+            floatFormat = std::chars_format::scientific;
+        } else if (field == (std::ios_base::fixed | std::ios_base::scientific)) {
+            fast = false;  // hexfloat prints a 0x prefix that to_chars omits
+        }
+        precision = static_cast<int>(os.precision());
+    }
+
+    BulkWriter(const BulkWriter&) = delete;
+    BulkWriter& operator=(const BulkWriter&) = delete;
+
+    ~BulkWriter() {
+        flush();
+        ScratchArena::release(block, BlockSize);
+    }
+
+    // Appends value as operator<< would print it.
+    template<typename T>
+    void value(const T& v) {
+        if constexpr (detail::bulkFormattable<T>) {
+            if (fast) {
+                // Room for any integer and for all but extreme fixed-notation floats
+                if (BlockSize - used < 512) {
+                    flush();
+                }
+                std::to_chars_result r;
+                if constexpr (std::is_floating_point_v<T>) {
+                    r = std::to_chars(block + used, block + BlockSize, v, floatFormat, precision);
+                } else {
+                    r = std::to_chars(block + used, block + BlockSize, v);
+                }
+                if (r.ec == std::errc()) {
+                    used = static_cast<size_t>(r.ptr - block);
+                    return;
+                }
+            }
+        }
+        flush();
+        os << v;
+    }
+
+    void text(const char* s, size_t n) {
+        if (!fast) {
+            os << std::string_view(s, n);  // Formatted, so a pending width still applies
+            return;
+        }
+        if (n > BlockSize - used) {
+            flush();
+            if (n > BlockSize) {
+                os.write(s, static_cast<std::streamsize>(n));
+                return;
+            }
+        }
+        std::memcpy(block + used, s, n);
+        used += n;
+    }
+
+    void flush() {
+        if (used > 0) {
+            os.write(block, static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+private:
+    std::ostream& os;
+    char* block;
+    size_t used = 0;
+    bool fast = false;
+    std::chars_format floatFormat = std::chars_format::general;
+    int precision = 6;
+};
+
+/**
+ * Writes the elements of [first, last) as "[a, b, c]", e.g. one traversal order of a
+ * MyContainer.
+ */
+template<typename Iterator>
+void print(std::ostream& os, Iterator first, Iterator last) {
+    BulkWriter out(os);
+    out.text("[", 1);
+    bool separate = false;
+    for (; first != last; ++first) {
+        if (separate) {
+            out.text(", ", 2);
+        }
+        out.value(*first);
+        separate = true;
+    }
+    out.text("]", 1);
+}
+
+} // namespace io
+} // namespace container
+
+#endif // FORMAT_HPP
@@ -0,0 +1,157 @@
+// eitan.derdiger@gmail.com
+
+#ifndef PARSE_HPP
+#define PARSE_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "../iterators/ScratchArena.hpp"
+
+/*
+  Parse.hpp holds the text reader behind MyContainer<T>::parse(), the inverse of
+  operator<<.
+
+  Accepted text: numbers separated by commas and/or whitespace, so both operator<<
+  output ("[1, 2, 3]") and one number per line work; '[' and ']' are skipped like
+  separators. Each number is read with std::from_chars (an optional leading '+' is
+  allowed, but not in front of a '-'), so T must be arithmetic.
+
+    - io::parseInto<T>(buf, text):  parses a string_view, reserving once for the number
+      of tokens (runs of non-separators, whatever separates them) found by a first
+      counting pass.
+    - io::parseInto<T>(buf, in):    reads the stream in 1 MiB chunks (a number cut by a
+      chunk border is carried to the next chunk). After the first chunk, seekable
+      streams reserve once for the rest, estimated from that chunk's bytes per number.
+
+  Both throw std::runtime_error on a token that is not a valid T, naming its offset.
+*/
+
+namespace container {
+namespace io {
+
+namespace detail {
+
+struct SeparatorTable {
+    bool table[256] = {};
+    constexpr SeparatorTable() {
+        for (unsigned char c : {',', ' ', '\n', '\r', '\t', '[', ']'}) {
+            table[c] = true;
+        }
+    }
+};
+
+inline bool isSeparator(char c) noexcept {
+    static constexpr SeparatorTable separators;
+    return separators.table[static_cast<unsigned char>(c)];
+}
+
+/*
+  Parses the numbers in [p, end) into buf. If more text follows (final == false), a
+  number touching end may be incomplete and is left unparsed; the return value is
+  where parsing stopped. `offset` is the position of p in the whole input.
+*/
+template<typename T, typename Buffer>
+const char* parseNumbers(Buffer& buf, const char* p, const char* end, bool final, size_t offset) {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "parse() needs an arithmetic T");
+    const char* begin = p;
+    while (true) {
+        while (p != end && isSeparator(*p)) {
+            ++p;
+        }
+        if (p == end) {
+            return p;
+        }
+        // from_chars finds the end of the number itself; it must be followed by a separator
+        bool plus = *p == '+';
+        const char* digits = plus ? p + 1 : p;
+        T value{};
+        std::from_chars_result r = std::from_chars(digits, end, value);
+        bool valid = r.ec == std::errc() && (r.ptr == end || isSeparator(*r.ptr)) &&
+                     !(plus && *digits == '-');  // from_chars would accept the '-' of "+-5"
+        if (!final && (r.ptr == end || (!valid && std::find_if(p, end, isSeparator) == end))) {
+            return p;  // The token touches end ("12", "-", "1.5e") and may continue in the next chunk
+        }
+        if (!valid) {
+            throw std::runtime_error("Invalid number at offset " +
+                                     std::to_string(offset + static_cast<size_t>(p - begin)));
+        }
+        buf.push_back(value);
+        p = r.ptr;
+    }
+}
+
+} // namespace detail
+
+template<typename T, typename Buffer>
+void parseInto(Buffer& buf, std::string_view text) {
+    // A token starts at every non-separator that follows a separator (or the start)
+    size_t tokens = 0;
+    bool inToken = false;
+    for (char c : text) {
+        bool separator = detail::isSeparator(c);
+        tokens += static_cast<size_t>(!separator && !inToken);
+        inToken = !separator;
+    }
+    buf.reserve(buf.size() + tokens);
+    detail::parseNumbers<T>(buf, text.data(), text.data() + text.size(), true, 0);
+}
+
+template<typename T, typename Buffer>
+void parseInto(Buffer& buf, std::istream& in) {
+    constexpr size_t Chunk = size_t(1) << 20;
+    char* block = static_cast<char*>(ScratchArena::allocate(Chunk));
+    struct Release {
+        char* block;
+        ~Release() { ScratchArena::release(block, Chunk); }
+    } release{block};
+
+    size_t carried = 0;   // Bytes of an unfinished number kept at the front of block
+    size_t consumed = 0;  // Input offset of block[0]
+    bool reserved = false;
+    while (true) {
+        in.read(block + carried, static_cast<std::streamsize>(Chunk - carried));
+        if (in.bad()) {
+            throw std::runtime_error("Read failed");
+        }
+        size_t filled = carried + static_cast<size_t>(in.gcount());
+        bool final = in.eof() || in.gcount() == 0;
+        size_t before = buf.size();
+        const char* stop = detail::parseNumbers<T>(buf, block, block + filled, final, consumed);
+        if (final) {
+            return;
+        }
+        carried = static_cast<size_t>(block + filled - stop);
+        if (carried == Chunk) {
+            throw std::runtime_error("Invalid number at offset " + std::to_string(consumed));
+        }
+
+        if (!reserved && buf.size() > before) {
+            // Estimate the rest from this chunk's bytes per number
+            reserved = true;
+            std::istream::pos_type here = in.tellg();
+            if (here != std::istream::pos_type(-1) && in.seekg(0, std::ios::end)) {
+                std::istream::pos_type last = in.tellg();
+                in.seekg(here);
+                size_t remaining = static_cast<size_t>(last - here) + carried;
+                size_t perNumber = std::max<size_t>(1, (filled - carried) / (buf.size() - before));
+                buf.reserve(buf.size() + remaining / perNumber + 1);
+            } else {
+                in.clear();
+            }
+        }
+        std::memmove(block, stop, carried);
+        consumed += filled - carried;
+    }
+}
+
+} // namespace io
+} // namespace container
+
+#endif // PARSE_HPP
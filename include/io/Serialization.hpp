@@ -0,0 +1,434 @@
+// eitan.derdiger@gmail.com
+
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../MyContainer.hpp"
+
+/*
+  Serialization.hpp holds the versioned binary file format of MyContainer.
+
+  Layout (native byte order, checked on read):
+    - A 48-byte header: magic "MYCT", format version, byte-order mark, element type
+      code, element size, flags, element count, the checksum of the element bytes and
+      the checksum of the stored permutation (0 without one).
+    - The elements in insertion order: trivially copyable T as one raw block (exact
+      bit patterns, so doubles round-trip losslessly); std::string as a 64-bit length
+      followed by the bytes.
+    - Optionally (header flag HasPermutation), at the next 8-byte boundary: the element
+      checksum the permutation was built for, the element count and the ascending
+      permutation as 64-bit positions. Comparing that checksum with the header's binds
+      the permutation to the data without reading either.
+
+  Functions:
+    - io::save(container, path, withPermutation): writes the live elements, and the
+      ascending permutation if asked (built first if the container has none cached).
+    - io::load<T>(path):           reads a file into a regular MyContainer; the elements
+      and a stored permutation are checked against their checksums, and the permutation
+      becomes the sorted cache.
+    - io::openMapped<T>(path, verify): maps the file read-only and returns a
+      MyContainer<T, std::allocator<T>, MappedStorage> that traverses the mapped
+      pages in place; nothing is read up front, and the first mutation copies the
+      elements into memory (the file itself is never written). A stored permutation
+      is used in place too, so AscendingOrder, DescendingOrder and SideCrossOrder
+      start without sorting. By default opening is O(1): only the header, the file
+      length and the permutation's binding checksum are checked. verify adds the
+      checksums over the whole file and a check that the positions are a permutation.
+
+  All functions throw std::runtime_error on I/O failures and on files that are not
+  MyContainer files, have another format version, or hold another element type.
+*/
+
+namespace container {
+namespace io {
+
+constexpr uint32_t FormatVersion = 2;
+
+namespace detail {
+
+constexpr char Magic[4] = {'M', 'Y', 'C', 'T'};
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr uint32_t HasPermutation = 1;
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "Permutations are stored as 64-bit positions");
+
+// FNV-1a over 64-bit words. Partial words are buffered, so the result does not depend
+// on how the input is split across update() calls.
+class Checksum {
+public:
+    void update(const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        total += bytes;
+        while (bytes > 0 && pendingBytes > 0) {
+            pending[pendingBytes++] = *p++;
+            --bytes;
+            if (pendingBytes == 8) {
+                mix(pending);
+                pendingBytes = 0;
+            }
+        }
+        for (; bytes >= 8; p += 8, bytes -= 8) {
+            mix(p);
+        }
+        for (; bytes > 0; --bytes) {
+            pending[pendingBytes++] = *p++;
+        }
+    }
+
+    uint64_t value() const {
+        uint64_t h = state;
+        if (pendingBytes > 0) {
+            unsigned char last[8] = {};
+            std::memcpy(last, pending, pendingBytes);
+            uint64_t word;
+            std::memcpy(&word, last, sizeof(word));
+            h = (h ^ word) * Prime;
+        }
+        return (h ^ total) * Prime;
+    }
+
+private:
+    static constexpr uint64_t Prime = 1099511628211ull;
+    uint64_t state = 14695981039346656037ull;
+    uint64_t total = 0;
+    unsigned char pending[8] = {};
+    size_t pendingBytes = 0;
+
+    void mix(const unsigned char* p) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        state = (state ^ word) * Prime;
+    }
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t typeCode;
+    uint32_t elementSize;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t elementChecksum;
+    uint64_t permutationChecksum;
+};
+static_assert(sizeof(Header) == 48, "Header must stay a multiple of 16 bytes (keeps raw payloads aligned)");
+
+// Offset of the permutation section that follows payloadBytes of elements.
+inline uint64_t permutationOffset(uint64_t payloadBytes) {
+    return (sizeof(Header) + payloadBytes + 7) / 8 * 8;
+}
+
+// Every position must be below n and appear once (a wrong entry would read out of
+// bounds, a repeated one would hide an element).
+inline void checkPositions(const uint64_t* positions, uint64_t n) {
+    std::vector<uint64_t> seen(static_cast<size_t>((n + 63) / 64), 0);
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t p = positions[i];
+        if (p >= n || (seen[p / 64] >> (p % 64)) & 1u) {
+            throw std::runtime_error("Corrupt permutation");
+        }
+        seen[p / 64] |= uint64_t(1) << (p % 64);
+    }
+}
+
+template<typename T>
+constexpr bool isString = std::is_same_v<T, std::string>;
+
+// Distinguishes element types of equal size: 'S' strings, 'F' floating point,
+// 'I' / 'U' signed / unsigned integers, 'R' other trivially copyable types.
+template<typename T>
+constexpr uint32_t typeCode() {
+    static_assert(isString<T> || std::is_trivially_copyable_v<T>,
+                  "Only trivially copyable types and std::string can be serialized");
+    if constexpr (isString<T>) {
+        return 'S';
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return 'F';
+    } else if constexpr (std::is_integral_v<T>) {
+        return std::is_signed_v<T> ? 'I' : 'U';
+    } else {
+        return 'R';
+    }
+}
+
+template<typename T>
+Header makeHeader(uint64_t count) {
+    Header h{};
+    std::memcpy(h.magic, Magic, sizeof(Magic));
+    h.version = FormatVersion;
+    h.byteOrder = ByteOrderMark;
+    h.typeCode = typeCode<T>();
+    h.elementSize = isString<T> ? 0 : static_cast<uint32_t>(sizeof(T));
+    h.count = count;
+    return h;
+}
+
+template<typename T>
+void checkHeader(const Header& h) {
+    if (std::memcmp(h.magic, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("Not a MyContainer file");
+    }
+    if (h.version != FormatVersion) {
+        throw std::runtime_error("Unsupported format version");
+    }
+    if (h.byteOrder != ByteOrderMark) {
+        throw std::runtime_error("File was written with another byte order");
+    }
+    Header expected = makeHeader<T>(0);
+    if (h.typeCode != expected.typeCode || h.elementSize != expected.elementSize) {
+        throw std::runtime_error("Element type mismatch");
+    }
+}
+
+inline void readExactly(std::istream& in, void* out, size_t bytes) {
+    if (!in.read(static_cast<char*>(out), static_cast<std::streamsize>(bytes))) {
+        throw std::runtime_error("Truncated file");
+    }
+}
+
+} // namespace detail
+
+/**
+ * Writes the container's elements (insertion order) to path, replacing the file.
+ * @param withPermutation Also store the ascending permutation, so a reloaded or mapped
+ *        container serves the sorted orders without sorting.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+template<typename T, typename Alloc, typename Policy>
+void save(const MyContainer<T, Alloc, Policy>& cont, const std::string& path, bool withPermutation = false) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    detail::Header h = detail::makeHeader<T>(cont.size());
+    h.flags = withPermutation ? detail::HasPermutation : 0;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));  // Rewritten with the checksums
+
+    detail::Checksum checksum;
+    uint64_t payloadBytes = 0;
+    auto emit = [&](const void* bytes, size_t n) {
+        out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(n));
+        checksum.update(bytes, n);
+        payloadBytes += n;
+    };
+    cont.forEachSpan([&](const T* first, size_t n) {
+        if constexpr (detail::isString<T>) {
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t length = first[i].size();
+                emit(&length, sizeof(length));
+                emit(first[i].data(), length);
+            }
+        } else {
+            emit(first, n * sizeof(T));
+        }
+    });
+
+    h.elementChecksum = checksum.value();
+
+    if (withPermutation) {
+        IndexSequence ascending = cont.ascendingPermutation();
+        const char padding[8] = {};
+        out.write(padding, static_cast<std::streamsize>(detail::permutationOffset(payloadBytes) - sizeof(h) - payloadBytes));
+        uint64_t section[2] = {h.elementChecksum, ascending.size()};
+        out.write(reinterpret_cast<const char*>(section), sizeof(section));
+        out.write(reinterpret_cast<const char*>(ascending.data()),
+                  static_cast<std::streamsize>(ascending.size() * sizeof(size_t)));
+        detail::Checksum positions;
+        positions.update(ascending.data(), ascending.size() * sizeof(size_t));
+        h.permutationChecksum = positions.value();
+    }
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    if (!out.flush()) {
+        throw std::runtime_error("Write failed: " + path);
+    }
+}
+
+/**
+ * Reads a file written by save() into a new container, adopting a stored permutation.
+ * @throws std::runtime_error if the file is missing, malformed or holds another type,
+ *         or if a stored permutation fails its checksum.
+ */
+template<typename T, typename Alloc = std::allocator<T>, typename Policy = ContiguousStorage>
+MyContainer<T, Alloc, Policy> load(const std::string& path, const Alloc& alloc = Alloc()) {
+    static_assert(std::is_default_constructible_v<T>, "load() needs a default constructible T");
+    using Container = MyContainer<T, Alloc, Policy>;
+    using Storage = typename Container::Storage;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    detail::Header h;
+    detail::readExactly(in, &h, sizeof(h));
+    detail::checkHeader<T>(h);
+
+    // Reject a damaged count before reserving room for it
+    in.seekg(0, std::ios::end);
+    uint64_t payload = static_cast<uint64_t>(in.tellg()) - sizeof(h);
+    in.seekg(sizeof(h));
+    uint64_t minimumBytes = detail::isString<T> ? sizeof(uint64_t) : sizeof(T);
+    if (h.count > payload / minimumBytes) {
+        throw std::runtime_error("Truncated file");
+    }
+
+    detail::Checksum checksum;
+    uint64_t payloadBytes = 0;
+    auto take = [&](void* out, size_t n) {
+        detail::readExactly(in, out, n);
+        checksum.update(out, n);
+        payloadBytes += n;
+    };
+
+    auto buf = std::make_shared<Storage>(alloc);
+    buf->reserve(h.count);
+    if constexpr (detail::isString<T>) {
+        for (uint64_t i = 0; i < h.count; ++i) {
+            uint64_t length = 0;
+            take(&length, sizeof(length));
+            if (length > payload - payloadBytes) {  // Checked before allocating it
+                throw std::runtime_error("Truncated file");
+            }
+            std::string value(length, '\0');
+            take(value.data(), length);
+            buf->push_back(value);
+        }
+    } else {
+        // Read through a bounded staging block, then append
+        constexpr uint64_t Block = uint64_t(1) << 16;
+        std::vector<T> staging(static_cast<size_t>(std::min(Block, h.count)));
+        for (uint64_t done = 0; done < h.count;) {
+            size_t n = static_cast<size_t>(std::min(Block, h.count - done));
+            take(staging.data(), n * sizeof(T));
+            storage::append(*buf, staging.begin(), staging.begin() + static_cast<std::ptrdiff_t>(n));
+            done += n;
+        }
+    }
+    if (checksum.value() != h.elementChecksum) {
+        throw std::runtime_error("Checksum mismatch");
+    }
+    if (!(h.flags & detail::HasPermutation)) {
+        return Container(std::move(buf));
+    }
+
+    in.seekg(static_cast<std::streamoff>(detail::permutationOffset(payloadBytes)));
+    uint64_t section[2] = {};
+    detail::readExactly(in, section, sizeof(section));
+    if (section[0] != h.elementChecksum || section[1] != h.count) {
+        throw std::runtime_error("Permutation was built for other elements");
+    }
+    using IndexVector = typename Container::IndexVector;
+    auto ascending = container::detail::allocateShared<IndexVector>(
+        typename IndexVector::allocator_type(alloc), static_cast<size_t>(h.count));
+    detail::readExactly(in, ascending->data(), ascending->size() * sizeof(size_t));
+    detail::Checksum positions;
+    positions.update(ascending->data(), ascending->size() * sizeof(size_t));
+    if (positions.value() != h.permutationChecksum) {
+        throw std::runtime_error("Checksum mismatch");
+    }
+    detail::checkPositions(reinterpret_cast<const uint64_t*>(ascending->data()), h.count);
+    return Container(std::move(buf), IndexSequence(std::shared_ptr<const IndexVector>(ascending)));
+}
+
+/**
+ * Maps a file written by save() read-only and returns a container that reads its
+ * elements (and a stored permutation) from the mapping. The mapping lives as long as
+ * the container, its copies and its iterators; the first mutation copies the
+ * elements into memory.
+ * By default opening is O(1) and touches only the header and the permutation section's
+ * first bytes: the header, the file length and the checksum binding a stored
+ * permutation to these elements are checked, so a permutation saved with other data
+ * is rejected. The positions themselves are trusted; a file damaged in place can make
+ * the sorted orders read out of bounds unless it is opened with verify.
+ * @param verify Also check the elements and permutation against their checksums and
+ *        that every position appears once; this reads the whole file.
+ * @throws std::runtime_error if the file is missing, malformed or holds another type,
+ *         or if a stored permutation belongs to other elements (or, with verify, if
+ *         either section is damaged).
+ */
+template<typename T>
+MyContainer<T, std::allocator<T>, MappedStorage> openMapped(const std::string& path, bool verify = false) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be mapped");
+    using Container = MyContainer<T, std::allocator<T>, MappedStorage>;
+    using Storage = typename Container::Storage;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(detail::Header)) {
+        ::close(fd);
+        throw std::runtime_error("Truncated file");
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference to the file
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    std::shared_ptr<const void> region(addr, [length](const void* p) {
+        ::munmap(const_cast<void*>(p), length);
+    });
+
+    detail::Header h;
+    std::memcpy(&h, addr, sizeof(h));
+    detail::checkHeader<T>(h);
+    if (h.count > (length - sizeof(h)) / sizeof(T)) {
+        throw std::runtime_error("Truncated file");
+    }
+    const char* base = static_cast<const char*>(addr);
+    const T* first = reinterpret_cast<const T*>(base + sizeof(h));
+    uint64_t payloadBytes = h.count * sizeof(T);
+    if (verify) {
+        detail::Checksum checksum;
+        checksum.update(first, payloadBytes);
+        if (checksum.value() != h.elementChecksum) {
+            throw std::runtime_error("Checksum mismatch");
+        }
+    }
+    if (!(h.flags & detail::HasPermutation)) {
+        return Container(std::make_shared<Storage>(std::move(region), first, static_cast<size_t>(h.count)));
+    }
+
+    uint64_t offset = detail::permutationOffset(payloadBytes);
+    if (offset + 16 > length || h.count > (length - offset - 16) / sizeof(uint64_t)) {
+        throw std::runtime_error("Truncated file");
+    }
+    uint64_t section[2];
+    std::memcpy(section, base + offset, sizeof(section));
+    if (section[0] != h.elementChecksum || section[1] != h.count) {
+        throw std::runtime_error("Permutation was built for other elements");
+    }
+    const size_t* positions = reinterpret_cast<const size_t*>(base + offset + 16);
+    if (verify) {
+        detail::Checksum checksum;
+        checksum.update(positions, h.count * sizeof(size_t));
+        if (checksum.value() != h.permutationChecksum) {
+            throw std::runtime_error("Checksum mismatch");
+        }
+        detail::checkPositions(reinterpret_cast<const uint64_t*>(positions), h.count);
+    }
+    IndexSequence ascending(std::shared_ptr<const size_t>(region, positions), static_cast<size_t>(h.count));
+    return Container(std::make_shared<Storage>(std::move(region), first, static_cast<size_t>(h.count)),
+                     std::move(ascending));
+}
+
+} // namespace io
+} // namespace container
+
+#endif // SERIALIZATION_HPP
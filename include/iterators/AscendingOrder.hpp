@@ -13,40 +13,34 @@
   which iterates over container elements in ascending value order.
 
   This iterator:
-    - Precomputes an index sequence [0,1,…,n-1].
-    - Sorts indices by comparing container.elements[a] < container.elements[b].
+    - Shares the container's cached ascending index permutation (built on first use by
+      sorting indices with container.elements[a] < container.elements[b], or by merging
+      the runs added with addSortedRun()); small containers sort into inline storage.
     - Inherits BaseIterator<MyContainer<T>, T> for ++ and * operations.
 */
 
 namespace container {
 
-template<typename T>
+template<typename T, typename Alloc, typename Policy>
 class MyContainer;  // forward-declaration
 
 //Traverses the container in ascending order of element values.
-template<typename T>
-class MyContainer<T>::AscendingOrder : public BaseIterator<MyContainer<T>, T> {
+template<typename T, typename Alloc, typename Policy>
+class MyContainer<T, Alloc, Policy>::AscendingOrder : public BaseIterator<MyContainer<T, Alloc, Policy>, T> {
 public:
-    using Parent = BaseIterator<MyContainer<T>, T>;
+    using Parent = BaseIterator<MyContainer<T, Alloc, Policy>, T>;
 
     /**
      * @param cont Pointer to the container instance.
      * @param startIdx Starting index (default = 0 for begin; use container size for end).
      */
-    AscendingOrder(const MyContainer<T>* cont, size_t startIdx = 0)
-        : Parent(cont,
-                 std::make_shared<std::vector<size_t>>(cont->elements.size()),
-                 startIdx)
+    AscendingOrder(const MyContainer<T, Alloc, Policy>* cont, size_t startIdx = 0)
+        : Parent(cont, startIdx < cont->size() ? cont->ascendingSequence() : IndexSequence(), startIdx)
     {
-        auto& seq = *this->orderIndices;
-        size_t n = seq.size();
-        for (size_t i = 0; i < n; ++i) {
-            seq[i] = i;
-        }
-        std::sort(seq.begin(), seq.end(),
-                  [&](size_t a, size_t b) {
-                      return cont->elements[a] < cont->elements[b];
-                  });
+        // Shares the cached permutation (or is inline), so it allocates nothing
+        MYCONTAINER_STAT(if (startIdx < cont->size()) {
+            cont->countSequence(Traversal::Ascending, this->orderIndices, false);
+        })
     }
 };
 
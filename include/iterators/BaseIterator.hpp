@@ -7,6 +7,7 @@
 #include <memory>
 #include <stdexcept>
 #include "MyContainer.hpp"
+#include "IndexSequence.hpp"
 
 /*
   BaseIterator.hpp defines the template class BaseIterator<ContainerType, ValueType>,
@@ -14,7 +15,15 @@
 
   Purpose:
     - Stores a pointer to the container instance (containerPtr).
-    - Maintains a precomputed sequence of element indices in orderIndices.
+    - Pins the container's element buffer version (snapshot), so later add()/remove()
+      calls never change what the iterator reads.
+    - Maintains a precomputed sequence of element indices in orderIndices
+      (stored inline for small containers, see IndexSequence.hpp). End iterators
+      keep an empty sequence: they are only compared by index, so end*() never
+      sorts or allocates.
+    - Only an iterator that can still be dereferenced pins the buffer: end iterators
+      never take the pin, and an iterator drops it when it reaches the end. Holding
+      end() across add() therefore never forces the buffer to be copied.
     - Tracks the current position (index) within that sequence.
     - Provides operator++ (both prefix and postfix) and operator* for dereferencing.
 
@@ -28,14 +37,17 @@ namespace container {
 
 template<typename ContainerType, typename ValueType>
 class BaseIterator {
+    friend ContainerType;  // Parallel algorithms read the pinned sequence directly
+
 protected:
     const ContainerType* containerPtr = nullptr;
     size_t index = 0;
-    std::shared_ptr<std::vector<size_t>> orderIndices;
+    IndexSequence orderIndices;
+    std::shared_ptr<const typename ContainerType::Storage> snapshot;
 
     // Validate that dereference is within range
     void validateDereference() const {
-        if (!containerPtr || index >= orderIndices->size()) {
+        if (!containerPtr || index >= orderIndices.size()) {
             throw std::runtime_error("Iterator out of range");
         }
     }
@@ -48,20 +60,22 @@ public:
     using difference_type   = std::ptrdiff_t;
 
     BaseIterator() = default;
-    BaseIterator(const ContainerType* cont, std::shared_ptr<std::vector<size_t>> seq, size_t startIdx = 0)
-        : containerPtr(cont), index(startIdx), orderIndices(std::move(seq)) {}
+    BaseIterator(const ContainerType* cont, IndexSequence seq, size_t startIdx = 0)
+        : containerPtr(cont), index(startIdx), orderIndices(std::move(seq)),
+          snapshot(cont && startIdx < cont->size() ? cont->snapshot() : nullptr) {}
     BaseIterator(const BaseIterator& other) = default;
     BaseIterator& operator=(const BaseIterator& other) = default;
     virtual ~BaseIterator() = default;
 
     // Pre-increment: move to next index or to “end”
     BaseIterator& operator++() {
-        size_t n = orderIndices->size();
+        size_t n = orderIndices.size();
         if (index >= n) {
             throw std::runtime_error("Increment past end");
         }
         if (index + 1 >= n) {
             index = n;  // Move to one-past-last (end)
+            snapshot.reset();  // Nothing left to read
             return *this;
         }
         ++index;
@@ -78,7 +92,7 @@ public:
     // Dereference: return the element at the current index
     const ValueType& operator*() const {
         validateDereference();
-        return containerPtr->elements[(*orderIndices)[index]];
+        return (*snapshot)[orderIndices[index]];
     }
 
     // Equality: same container pointer and same index
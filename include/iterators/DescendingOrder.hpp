@@ -7,48 +7,43 @@
 #include <memory>
 #include <vector>
 #include "BaseIterator.hpp"
+#include "OrderSequences.hpp"
 
 /*
   DescendingOrder.hpp defines the nested iterator class MyContainer<T>::DescendingOrder,
   which iterates over container elements in descending value order.
 
   This iterator:
-    - Precomputes an index sequence [0,1,…,n-1].
-    - Sorts indices ascending by container.elements[a] < container.elements[b].
-    - Reverses the sorted sequence to obtain descending order.
+    - Takes the container's cached ascending index permutation.
+    - Reverses it to obtain descending order.
     - Inherits BaseIterator<MyContainer<T>, T> for ++ and * operations.
 */
 
 namespace container {
 
-template<typename T>
+template<typename T, typename Alloc, typename Policy>
 class MyContainer;  // forward-declaration
 
 //Traverses the container in descending order of element values.
-template<typename T>
-class MyContainer<T>::DescendingOrder : public BaseIterator<MyContainer<T>, T> {
+template<typename T, typename Alloc, typename Policy>
+class MyContainer<T, Alloc, Policy>::DescendingOrder : public BaseIterator<MyContainer<T, Alloc, Policy>, T> {
 public:
-    using Parent = BaseIterator<MyContainer<T>, T>;
+    using Parent = BaseIterator<MyContainer<T, Alloc, Policy>, T>;
 
     /**
      * @param cont Pointer to the container instance.
      * @param startIdx Starting index (default = 0 for begin; using container size for end).
      */
-    DescendingOrder(const MyContainer<T>* cont, size_t startIdx = 0)
-        : Parent(cont,
-                 std::make_shared<std::vector<size_t>>(cont->elements.size()),
-                 startIdx)
+    DescendingOrder(const MyContainer<T, Alloc, Policy>* cont, size_t startIdx = 0)
+        : Parent(cont, IndexSequence(), startIdx)
     {
-        auto& seq = *this->orderIndices;
-        size_t n = seq.size();
-        for (size_t i = 0; i < n; ++i) {
-            seq[i] = i;
-        }
-        std::sort(seq.begin(), seq.end(),
-                  [&](size_t a, size_t b) {
-                      return cont->elements[a] < cont->elements[b];
-                  });
-        std::reverse(seq.begin(), seq.end());
+        if (startIdx >= cont->size()) return;  // End iterators compare by index only and need no sequence
+        IndexSequence ascending = cont->ascendingSequence();
+        size_t n = ascending.size();
+        this->orderIndices = IndexSequence::build(n, [&](size_t* seq) {
+            orders::descending(ascending.data(), n, seq);
+        }, cont->sequenceAllocator());
+        MYCONTAINER_STAT(cont->countSequence(Traversal::Descending, this->orderIndices));
     }
 };
 
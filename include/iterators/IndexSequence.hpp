@@ -0,0 +1,113 @@
+// eitan.derdiger@gmail.com
+
+#ifndef INDEXSEQUENCE_HPP
+#define INDEXSEQUENCE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+  IndexSequence.hpp defines the class IndexSequence, the precomputed sequence of
+  element indices that every MyContainer<T> iterator walks.
+
+  Storage:
+    - Sequences of up to InlineCapacity (16) indices are stored inside the object
+      itself, so iterators over small containers never touch the heap.
+    - Longer sequences live in a reference-counted index vector obtained from the
+      container's allocator; copies of the sequence (and of the iterator holding it)
+      share that vector.
+
+  build(n, fill, alloc) picks the storage for n indices and calls fill(size_t* out)
+  once to write them; wrapping an existing shared vector (such as the container's
+  cached ascending permutation) or any other shared block of indices (such as one
+  mapped from a file) never copies it.
+*/
+
+namespace container {
+
+namespace detail {
+
+/*
+  Creates a shared vector (or other allocator-aware buffer) whose control block and
+  contents both come from alloc. polymorphic_allocator hands itself to the buffer it
+  constructs, so it must not be passed twice.
+*/
+template<typename Buffer, typename A, typename... Args>
+std::shared_ptr<Buffer> allocateShared(const A& alloc, Args&&... args) {
+    using Value = typename std::allocator_traits<A>::value_type;
+    if constexpr (std::is_same_v<A, std::pmr::polymorphic_allocator<Value>>) {
+        return std::allocate_shared<Buffer>(alloc, std::forward<Args>(args)...);
+    } else {
+        return std::allocate_shared<Buffer>(alloc, std::forward<Args>(args)..., alloc);
+    }
+}
+
+} // namespace detail
+
+class IndexSequence {
+public:
+    static constexpr size_t InlineCapacity = 16;
+
+    IndexSequence() = default;
+
+    // Shares an existing vector of indices (null = empty sequence).
+    template<typename IndexAlloc>
+    explicit IndexSequence(std::shared_ptr<const std::vector<size_t, IndexAlloc>> seq)
+        : shared(seq, seq ? seq->data() : nullptr), count(seq ? seq->size() : 0) {}
+
+    // Shares n indices at `indices`, kept alive by that pointer's owner.
+    IndexSequence(std::shared_ptr<const size_t> indices, size_t n)
+        : shared(n ? std::move(indices) : nullptr), count(n) {}
+
+    /**
+     * Sequence of n indices written by fill(size_t* out).
+     * @param alloc Allocator for size_t, used only when n exceeds InlineCapacity.
+     */
+    template<typename Fill, typename IndexAlloc = std::allocator<size_t>>
+    static IndexSequence build(size_t n, Fill fill, const IndexAlloc& alloc = IndexAlloc()) {
+        IndexSequence seq;
+        seq.count = n;
+        if (n <= InlineCapacity) {
+            fill(seq.local.data());
+        } else {
+            using Heap = std::vector<size_t, IndexAlloc>;
+            auto heap = detail::allocateShared<Heap>(alloc, n);
+            size_t* out = heap->data();
+            fill(out);
+            seq.shared = std::shared_ptr<const size_t>(heap, out);
+        }
+        return seq;
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    const size_t* data() const noexcept {
+        return shared ? shared.get() : local.data();
+    }
+
+    size_t operator[](size_t i) const noexcept {
+        return data()[i];
+    }
+
+    // True if the indices are stored in the object rather than on the heap.
+    bool isInline() const noexcept {
+        return !shared;
+    }
+
+private:
+    std::shared_ptr<const size_t> shared;  // Aliases the data of the owning heap vector
+    size_t count = 0;
+    std::array<size_t, InlineCapacity> local{};
+};
+
+} // namespace container
+
+#endif // INDEXSEQUENCE_HPP
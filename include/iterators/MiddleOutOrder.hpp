@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 #include "BaseIterator.hpp"
+#include "OrderSequences.hpp"
 
 /*
   MiddleOutOrder.hpp defines the nested iterator class MyContainer<T>::MiddleOutOrder,
@@ -16,55 +17,41 @@
   This iterator:
     - Computes the container size n.
     - Calculates mid = (n-1)/2.
-    - Pushes mid onto orderIndices.
-    - Alternately pushes left and right indices until all indices are in orderIndices.
+    - Writes mid first into orderIndices.
+    - Alternately writes left and right indices until all indices are in orderIndices.
     - Inherits BaseIterator<MyContainer<T>, T> for ++ and * operations.
 */
 
 namespace container {
 
-template<typename T>
+template<typename T, typename Alloc, typename Policy>
 class MyContainer;  // forward-declaration 
 
 //Traverses the container in a "middle-out" pattern.
-template<typename T>
-class MyContainer<T>::MiddleOutOrder : public BaseIterator<MyContainer<T>, T> {
+template<typename T, typename Alloc, typename Policy>
+class MyContainer<T, Alloc, Policy>::MiddleOutOrder : public BaseIterator<MyContainer<T, Alloc, Policy>, T> {
 public:
-    using Parent = BaseIterator<MyContainer<T>, T>;
+    using Parent = BaseIterator<MyContainer<T, Alloc, Policy>, T>;
 
     /**
      * @param cont Pointer to the container instance.
      * @param startIdx Starting index (default = 0 for begin; use container size for end).
      */
-    MiddleOutOrder(const MyContainer<T>* cont, size_t startIdx = 0)
-        : Parent(cont, std::make_shared<std::vector<size_t>>(), startIdx)
+    MiddleOutOrder(const MyContainer<T, Alloc, Policy>* cont, size_t startIdx = 0)
+        : Parent(cont, IndexSequence(), startIdx)
     {
-        size_t n = cont->elements.size();
-        if (n == 0) return;
+        size_t n = cont->size();
+        if (startIdx >= n) return;  // End iterators compare by index only and need no sequence
 
-        auto seqPtr = this->orderIndices;
-        seqPtr->reserve(n);
-
-        size_t mid = (n - 1) / 2;
-        seqPtr->push_back(mid);
-
-        size_t left = (mid == 0 ? n : mid) - 1;
-        size_t right = mid + 1;
-        while (seqPtr->size() < n) {
-            if (left < n) {
-                seqPtr->push_back(left);
-                if (seqPtr->size() == n) break;
-            }
-            if (right < n) {
-                seqPtr->push_back(right);
-            }
-            if (left == 0) {
-                left = n;  // mark invalid
+        // Middle first, then alternately left and right of it
+        this->orderIndices = IndexSequence::build(n, [cont, n](size_t* seq) {
+            if (cont->deadCount > 0) {
+                cont->scatterLiveSlots(seq, [n](size_t p) { return orders::middleOutRank(p, n); });
             } else {
-                --left;
+                orders::middleOut(n, seq);
             }
-            ++right;
-        }
+        }, cont->sequenceAllocator());
+        MYCONTAINER_STAT(cont->countSequence(Traversal::MiddleOut, this->orderIndices));
     }
 };
 
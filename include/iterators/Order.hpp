@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 #include "BaseIterator.hpp"
+#include "OrderSequences.hpp"
 
 /*
   Order.hpp defines the nested iterator class MyContainer<T>::Order,
@@ -17,29 +18,32 @@
 
 namespace container {
 
-template<typename T>
+template<typename T, typename Alloc, typename Policy>
 class MyContainer;  // forward-declaration to allow nested definition
 
 //Traverses the container in insertion order: first inserted to last.
-template<typename T>
-class MyContainer<T>::Order : public BaseIterator<MyContainer<T>, T> {
+template<typename T, typename Alloc, typename Policy>
+class MyContainer<T, Alloc, Policy>::Order : public BaseIterator<MyContainer<T, Alloc, Policy>, T> {
 public:
-    using Parent = BaseIterator<MyContainer<T>, T>;
+    using Parent = BaseIterator<MyContainer<T, Alloc, Policy>, T>;
 
     /**
      * @param cont Pointer to the container instance.
      * @param startIdx Starting index (default = 0 for begin; use container size for end).
      */
-    Order(const MyContainer<T>* cont, size_t startIdx = 0)
-        : Parent(cont,
-                 std::make_shared<std::vector<size_t>>(cont->elements.size()),
-                 startIdx)
+    Order(const MyContainer<T, Alloc, Policy>* cont, size_t startIdx = 0)
+        : Parent(cont, IndexSequence(), startIdx)
     {
-        auto& seq = *this->orderIndices;
-        size_t n = seq.size();
-        for (size_t i = 0; i < n; ++i) {
-            seq[i] = i;
-        }
+        size_t n = cont->size();
+        if (startIdx >= n) return;  // End iterators compare by index only and need no sequence
+        this->orderIndices = IndexSequence::build(n, [cont, n](size_t* seq) {
+            if (cont->deadCount > 0) {
+                cont->scatterLiveSlots(seq, [](size_t p) { return p; });
+            } else {
+                orders::insertion(n, seq);
+            }
+        }, cont->sequenceAllocator());
+        MYCONTAINER_STAT(cont->countSequence(Traversal::Order, this->orderIndices));
     }
 };
 
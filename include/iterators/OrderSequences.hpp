@@ -0,0 +1,101 @@
+// eitan.derdiger@gmail.com
+
+#ifndef ORDERSEQUENCES_HPP
+#define ORDERSEQUENCES_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+/*
+  OrderSequences.hpp holds the index-sequence builders behind the six traversal
+  orders, shared by the MyContainer iterators and by SoAContainer.
+
+  Traversal names the six orders for code that picks one at run time (SoAContainer
+  views, the MyContainer stats counters).
+
+  Each function writes n indices to out:
+    - insertion(n, out):         0, 1, ..., n-1
+    - reverse(n, out):           n-1, ..., 0
+    - descending(asc, n, out):   the ascending permutation asc, reversed
+    - sideCross(asc, n, out):    asc[0], asc[n-1], asc[1], asc[n-2], ...
+    - middleOut(n, out):         (n-1)/2, then alternately left and right of it
+
+  middleOutRank(p, n) is the inverse of middleOut: the step at which position p is
+  visited, so a sequence can be scattered into middle-out order in one pass.
+*/
+
+namespace container {
+
+enum class Traversal { Order, Ascending, Descending, Reverse, SideCross, MiddleOut };
+
+namespace orders {
+
+inline void insertion(size_t n, size_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = i;
+    }
+}
+
+inline void reverse(size_t n, size_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = n - 1 - i;
+    }
+}
+
+inline void descending(const size_t* asc, size_t n, size_t* out) {
+    std::reverse_copy(asc, asc + n, out);
+}
+
+inline void sideCross(const size_t* asc, size_t n, size_t* out) {
+    if (n == 0) return;
+    size_t k = 0;
+    size_t lo = 0, hi = n - 1;
+    while (lo <= hi) {
+        out[k++] = asc[lo];
+        if (lo != hi) {
+            out[k++] = asc[hi];
+        }
+        ++lo;
+        if (hi == 0) break;  // prevent underflow
+        --hi;
+    }
+}
+
+inline void middleOut(size_t n, size_t* out) {
+    if (n == 0) return;
+    size_t k = 0;
+    size_t mid = (n - 1) / 2;
+    out[k++] = mid;
+
+    size_t left = (mid == 0 ? n : mid) - 1;
+    size_t right = mid + 1;
+    while (k < n) {
+        if (left < n) {
+            out[k++] = left;
+            if (k == n) break;
+        }
+        if (right < n) {
+            out[k++] = right;
+        }
+        if (left == 0) {
+            left = n;  // mark invalid
+        } else {
+            --left;
+        }
+        ++right;
+    }
+}
+
+inline size_t middleOutRank(size_t p, size_t n) {
+    size_t mid = (n - 1) / 2;
+    if (p < mid) {
+        return 2 * (mid - p) - 1;  // Left of the middle, paired with the right side
+    }
+    size_t d = p - mid;
+    return d <= mid ? 2 * d : mid + d;  // Past the left side's end only the right is left
+}
+
+} // namespace orders
+} // namespace container
+
+#endif // ORDERSEQUENCES_HPP
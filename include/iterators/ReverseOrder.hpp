@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 #include "BaseIterator.hpp"
+#include "OrderSequences.hpp"
 
 /*
   ReverseOrder.hpp defines the nested iterator class MyContainer<T>::ReverseOrder,
@@ -18,30 +19,33 @@
 
 namespace container {
 
-template<typename T>
+template<typename T, typename Alloc, typename Policy>
 class MyContainer;  // forward-declaration to allow nested definition
 
 //Traverses in reverse insertion order: last inserted to first.
-template<typename T>
-class MyContainer<T>::ReverseOrder : public BaseIterator<MyContainer<T>, T> {
+template<typename T, typename Alloc, typename Policy>
+class MyContainer<T, Alloc, Policy>::ReverseOrder : public BaseIterator<MyContainer<T, Alloc, Policy>, T> {
 public:
-    using Parent = BaseIterator<MyContainer<T>, T>;
+    using Parent = BaseIterator<MyContainer<T, Alloc, Policy>, T>;
 
     /**
      * @param cont Pointer to the container instance.
      * @param startIdx Starting index (default = 0 for begin; use container size for end).
      */
-    ReverseOrder(const MyContainer<T>* cont, size_t startIdx = 0)
-        : Parent(cont,
-                 std::make_shared<std::vector<size_t>>(cont->elements.size()),
-                 startIdx)
+    ReverseOrder(const MyContainer<T, Alloc, Policy>* cont, size_t startIdx = 0)
+        : Parent(cont, IndexSequence(), startIdx)
     {
-        auto& seq = *this->orderIndices;
-        size_t n = seq.size();
+        size_t n = cont->size();
+        if (startIdx >= n) return;  // End iterators compare by index only and need no sequence
         // Fill with indices in reverse: n-1, n-2, …, 0
-        for (size_t i = 0; i < n; ++i) {
-            seq[i] = n - 1 - i;
-        }
+        this->orderIndices = IndexSequence::build(n, [cont, n](size_t* seq) {
+            if (cont->deadCount > 0) {
+                cont->scatterLiveSlots(seq, [n](size_t p) { return n - 1 - p; });
+            } else {
+                orders::reverse(n, seq);
+            }
+        }, cont->sequenceAllocator());
+        MYCONTAINER_STAT(cont->countSequence(Traversal::Reverse, this->orderIndices));
     }
 };
 
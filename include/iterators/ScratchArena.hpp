@@ -0,0 +1,183 @@
+// eitan.derdiger@gmail.com
+
+#ifndef SCRATCHARENA_HPP
+#define SCRATCHARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/*
+  ScratchArena.hpp defines the per-thread block cache that backs the heap index
+  sequences of MyContainer iterators (see IndexSequence.hpp).
+
+  Behavior:
+    - Blocks are grouped in power-of-two size classes (64 bytes to 4 MiB). A released
+      block is kept on its class's free list (up to MaxCachedPerClass blocks) and handed
+      out again by the next request of that class on the same thread, so repeated
+      begin/end constructions stop calling the global allocator once warm.
+    - A thread caches at most MaxCachedBytes (8 MiB) in total. Larger blocks, and
+      blocks released beyond the per-class or per-thread limit, go straight back to
+      ::operator delete.
+    - trim() frees every block the calling thread has cached.
+    - Each thread has its own arena, so no locking is needed. A block released on a
+      different thread than the one that obtained it simply joins the releasing
+      thread's cache.
+    - ScratchAllocator<U> is a standard allocator over the calling thread's arena.
+
+  ScratchArena::stats() reports the calling thread's counters: blocks obtained from the
+  global allocator, blocks served from the cache, and blocks and bytes currently cached.
+*/
+
+namespace container {
+
+class ScratchArena {
+public:
+    static constexpr size_t MinClassBits = 6;   // 64-byte blocks
+    static constexpr size_t MaxClassBits = 22;  // 4 MiB blocks
+    static constexpr size_t MaxCachedPerClass = 8;
+    static constexpr size_t MaxCachedBytes = size_t(8) << 20;  // Per thread, all classes
+
+    struct Stats {
+        size_t allocations = 0;  // Blocks obtained from ::operator new
+        size_t reuses = 0;       // Requests served from the cache
+        size_t cached = 0;       // Blocks currently held for reuse
+        size_t cachedBytes = 0;  // Their total size
+    };
+
+    ScratchArena() = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    ~ScratchArena() {
+        freeAll();
+        destroyed() = true;
+    }
+
+    // Counters of the calling thread's arena.
+    static Stats stats() {
+        return destroyed() ? Stats{} : local().counters;
+    }
+
+    // Frees every block cached by the calling thread; returns the bytes released.
+    static size_t trim() noexcept {
+        if (destroyed()) return 0;
+        ScratchArena& arena = local();
+        size_t bytes = arena.counters.cachedBytes;
+        arena.freeAll();
+        return bytes;
+    }
+
+    // Returns a block of at least bytes bytes (aligned for any fundamental type).
+    static void* allocate(size_t bytes) {
+        size_t cls = sizeClass(bytes);
+        if (cls > MaxClassBits || destroyed()) {
+            return ::operator new(bytes);
+        }
+        ScratchArena& arena = local();
+        auto& list = arena.freeLists[cls - MinClassBits];
+        if (!list.empty()) {
+            void* block = list.back();
+            list.pop_back();
+            ++arena.counters.reuses;
+            --arena.counters.cached;
+            arena.counters.cachedBytes -= size_t(1) << cls;
+            return block;
+        }
+        ++arena.counters.allocations;
+        return ::operator new(size_t(1) << cls);
+    }
+
+    // Returns a block obtained from allocate(bytes) to the calling thread's cache.
+    static void release(void* block, size_t bytes) noexcept {
+        size_t cls = sizeClass(bytes);
+        if (cls > MaxClassBits || destroyed()) {
+            ::operator delete(block);
+            return;
+        }
+        ScratchArena& arena = local();
+        auto& list = arena.freeLists[cls - MinClassBits];
+        size_t blockBytes = size_t(1) << cls;
+        if (list.size() >= MaxCachedPerClass || arena.counters.cachedBytes + blockBytes > MaxCachedBytes) {
+            ::operator delete(block);
+            return;
+        }
+        list.push_back(block);  // Capacity reserved up front, so this cannot throw
+        ++arena.counters.cached;
+        arena.counters.cachedBytes += blockBytes;
+    }
+
+private:
+    static constexpr size_t ClassCount = MaxClassBits - MinClassBits + 1;
+
+    std::array<std::vector<void*>, ClassCount> freeLists = makeFreeLists();
+    Stats counters;
+
+    static std::array<std::vector<void*>, ClassCount> makeFreeLists() {
+        std::array<std::vector<void*>, ClassCount> lists;
+        for (auto& list : lists) {
+            list.reserve(MaxCachedPerClass);
+        }
+        return lists;
+    }
+
+    void freeAll() noexcept {
+        for (auto& list : freeLists) {
+            for (void* block : list) {
+                ::operator delete(block);
+            }
+            list.clear();
+        }
+        counters.cached = 0;
+        counters.cachedBytes = 0;
+    }
+
+    // Smallest class c >= MinClassBits with 2^c >= bytes.
+    static size_t sizeClass(size_t bytes) noexcept {
+        size_t cls = MinClassBits;
+        while ((size_t(1) << cls) < bytes && cls <= MaxClassBits) {
+            ++cls;
+        }
+        return cls;
+    }
+
+    static ScratchArena& local() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    // Set once this thread's arena has been destroyed (blocks may still be released
+    // later by thread-exit or static destructors; they bypass the cache then).
+    static bool& destroyed() noexcept {
+        thread_local bool flag = false;
+        return flag;
+    }
+};
+
+// Standard allocator drawing from the calling thread's ScratchArena.
+template<typename U>
+struct ScratchAllocator {
+    using value_type = U;
+
+    ScratchAllocator() noexcept = default;
+    template<typename V>
+    ScratchAllocator(const ScratchAllocator<V>&) noexcept {}
+
+    U* allocate(size_t n) {
+        return static_cast<U*>(ScratchArena::allocate(n * sizeof(U)));
+    }
+
+    void deallocate(U* p, size_t n) noexcept {
+        ScratchArena::release(p, n * sizeof(U));
+    }
+
+    template<typename V>
+    bool operator==(const ScratchAllocator<V>&) const noexcept { return true; }
+    template<typename V>
+    bool operator!=(const ScratchAllocator<V>&) const noexcept { return false; }
+};
+
+} // namespace container
+
+#endif // SCRATCHARENA_HPP
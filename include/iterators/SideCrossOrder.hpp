@@ -7,6 +7,7 @@
 #include <memory>
 #include <vector>
 #include "BaseIterator.hpp"
+#include "OrderSequences.hpp"
 
 /*
   SideCrossOrder.hpp defines the nested iterator class MyContainer<T>::SideCrossOrder,
@@ -15,8 +16,8 @@
       then the 2nd-smallest, then the 2nd-largest, and so on.
 
   Behavior:
-    - Compute a vector of indices [0, 1, ..., n-1].
-    - Sort those indices by comparing container.elements[a] < container.elements[b].
+    - Take the container's cached ascending index permutation
+      (indices sorted by container.elements[a] < container.elements[b]).
     - Then build a new sequence by alternately taking from the front (smallest)
       and back (largest) of the sorted index list.
     - Inherit BaseIterator<MyContainer<T>, T> for operator++ and operator* functionality.
@@ -24,51 +25,35 @@
 
 namespace container {
 
-template<typename T>
+template<typename T, typename Alloc, typename Policy>
 class MyContainer;  // forward-declaration to allow nested definition
 
 //Traverses the container in a "side-cross" pattern: smallest, largest, 2nd-smallest, 2nd-largest, etc.
-template<typename T>
-class MyContainer<T>::SideCrossOrder : public BaseIterator<MyContainer<T>, T> {
+template<typename T, typename Alloc, typename Policy>
+class MyContainer<T, Alloc, Policy>::SideCrossOrder : public BaseIterator<MyContainer<T, Alloc, Policy>, T> {
 public:
-    using Parent = BaseIterator<MyContainer<T>, T>;
+    using Parent = BaseIterator<MyContainer<T, Alloc, Policy>, T>;
 
     /**
      * @param cont Pointer to the container instance.
      * @param startIdx Starting index (default = 0 for begin; use container size for end).
      */
-    SideCrossOrder(const MyContainer<T>* cont, size_t startIdx = 0)
-        : Parent(cont, std::make_shared<std::vector<size_t>>(), startIdx)
+    SideCrossOrder(const MyContainer<T, Alloc, Policy>* cont, size_t startIdx = 0)
+        : Parent(cont, IndexSequence(), startIdx)
     {
-        size_t n = cont->elements.size();
-        if (n == 0) {
-            return;
+        size_t n = cont->size();
+        if (startIdx >= n) {
+            return;  // End iterators compare by index only and need no sequence
         }
 
-        // Create a vector of indices [0, 1, ..., n-1]
-        std::vector<size_t> ascIdx(n);
-        for (size_t i = 0; i < n; ++i) {
-            ascIdx[i] = i;
-        }
-        // Sort indices by element value
-        std::sort(ascIdx.begin(), ascIdx.end(),
-                  [&](size_t a, size_t b) {
-                      return cont->elements[a] < cont->elements[b];
-                  });
+        // Indices sorted by element value (the container's cached permutation)
+        IndexSequence ascIdx = cont->ascendingSequence();
 
         // Build the side-cross sequence: front, back, front+1, back-1, ...
-        auto seqPtr = this->orderIndices;
-        seqPtr->reserve(n);
-        size_t lo = 0, hi = n - 1;
-        while (lo <= hi) {
-            seqPtr->push_back(ascIdx[lo]);
-            if (lo != hi) {
-                seqPtr->push_back(ascIdx[hi]);
-            }
-            ++lo;
-            if (hi == 0) break;  // prevent underflow
-            --hi;
-        }
+        this->orderIndices = IndexSequence::build(n, [&](size_t* seq) {
+            orders::sideCross(ascIdx.data(), n, seq);
+        }, cont->sequenceAllocator());
+        MYCONTAINER_STAT(cont->countSequence(Traversal::SideCross, this->orderIndices));
     }
 };
 
@@ -0,0 +1,190 @@
+// eitan.derdiger@gmail.com
+
+#ifndef MULTIWAYMERGE_HPP
+#define MULTIWAYMERGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "WorkStealingPool.hpp"
+
+/*
+  MultiwayMerge.hpp merges k sorted runs of element indices into one sorted sequence.
+  It backs the sorted permutation of MyContainer<T> when the container was built from
+  pre-sorted runs (see MyContainer::addSortedRun).
+
+    - loserTreeMerge(): sequential k-way merge using a loser tree, O(n log k).
+      Ties are broken by run number, so equal elements keep their run order.
+    - parallelMultiwayMerge(): picks splitter elements from a sample of all runs, cuts
+      every run at each splitter with a binary search, and merges the resulting
+      independent output ranges concurrently on the work-stealing pool. Called from
+      inside a pool body, it merges sequentially.
+
+  Both take their scratch buffers from the allocator of the run list, so a container
+  with an arena allocator merges without touching the global heap.
+
+  A run is a pair of pointers [first, last) into an index array; less(a, b) compares the
+  elements behind indices a and b.
+*/
+
+namespace container {
+namespace parallel {
+
+using IndexRun = std::pair<const size_t*, const size_t*>;
+
+namespace detail {
+
+// Leaves of the loser tree over k runs (k rounded up to a power of two).
+inline size_t treeLeaves(size_t k) noexcept {
+    size_t leaves = 1;
+    while (leaves < k) {
+        leaves <<= 1;
+    }
+    return leaves;
+}
+
+// Merges runs[0, k) into out, advancing each run's first pointer as it is consumed.
+// losers must hold treeLeaves(k) entries; nothing is allocated.
+template<typename Less>
+void loserTreeMergeInto(IndexRun* runs, size_t k, size_t* out, Less less, size_t* losers) {
+    if (k == 0) return;
+    if (k == 1) {
+        std::copy(runs[0].first, runs[0].second, out);
+        return;
+    }
+    size_t leaves = treeLeaves(k);
+
+    // Does run a currently beat run b? Exhausted (and padding) runs lose to everything.
+    auto beats = [&](size_t a, size_t b) {
+        bool aDone = a >= k || runs[a].first == runs[a].second;
+        bool bDone = b >= k || runs[b].first == runs[b].second;
+        if (aDone || bDone) return !aDone;
+        if (less(*runs[b].first, *runs[a].first)) return false;
+        if (less(*runs[a].first, *runs[b].first)) return true;
+        return a < b;
+    };
+
+    // losers[node] keeps the loser of the match played at that node; losers[0] the winner.
+    auto build = [&](auto& self, size_t node) -> size_t {
+        if (node >= leaves) return node - leaves;
+        size_t left = self(self, 2 * node);
+        size_t right = self(self, 2 * node + 1);
+        if (beats(left, right)) {
+            losers[node] = right;
+            return left;
+        }
+        losers[node] = left;
+        return right;
+    };
+    losers[0] = build(build, 1);
+
+    size_t total = 0;
+    for (size_t r = 0; r < k; ++r) {
+        total += static_cast<size_t>(runs[r].second - runs[r].first);
+    }
+    for (size_t o = 0; o < total; ++o) {
+        size_t winner = losers[0];
+        out[o] = *runs[winner].first++;
+        // Replay the winner's path from its leaf to the root
+        for (size_t node = (winner + leaves) / 2; node >= 1; node /= 2) {
+            if (beats(losers[node], winner)) {
+                std::swap(losers[node], winner);
+            }
+        }
+        losers[0] = winner;
+    }
+}
+
+} // namespace detail
+
+// Sequential merge; its scratch (run heads and the tree) comes from runs' allocator.
+template<typename Less, typename RunAlloc>
+void loserTreeMerge(const std::vector<IndexRun, RunAlloc>& runs, size_t* out, Less less) {
+    using SizeAlloc = typename std::allocator_traits<RunAlloc>::template rebind_alloc<size_t>;
+    std::vector<IndexRun, RunAlloc> heads(runs.begin(), runs.end(), runs.get_allocator());
+    std::vector<size_t, SizeAlloc> losers(detail::treeLeaves(runs.size()), SizeAlloc(runs.get_allocator()));
+    detail::loserTreeMergeInto(heads.data(), heads.size(), out, less, losers.data());
+}
+
+/*
+  Every temporary (sample, cuts, per-part runs and loser trees) comes from runs'
+  allocator and is allocated on the calling thread before the pool starts, so the pool
+  bodies never allocate; an arena allocator that is not thread-safe (such as a
+  std::pmr::monotonic_buffer_resource) is therefore safe to use.
+*/
+template<typename Less, typename RunAlloc>
+void parallelMultiwayMerge(const std::vector<IndexRun, RunAlloc>& runs, size_t* out, Less less,
+                           WorkStealingPool& pool = WorkStealingPool::shared()) {
+    using Traits = std::allocator_traits<RunAlloc>;
+    using SizeAlloc = typename Traits::template rebind_alloc<size_t>;
+    using CutAlloc = typename Traits::template rebind_alloc<const size_t*>;
+
+    size_t total = 0;
+    for (const auto& r : runs) {
+        total += static_cast<size_t>(r.second - r.first);
+    }
+    size_t parts = pool.participants() * 2;
+    if (runs.size() < 2 || parts < 2 || total < (size_t(1) << 15) || pool.inBody()) {
+        loserTreeMerge(runs, out, less);
+        return;
+    }
+    size_t k = runs.size();
+
+    // Regular sample of every run, sorted; every samplesPerPart-th entry is a splitter
+    constexpr size_t samplesPerPart = 8;
+    auto takeFrom = [&](size_t len) {
+        return std::min(len, samplesPerPart * parts * len / total + 1);
+    };
+    size_t samples = 0;
+    for (const auto& r : runs) {
+        samples += takeFrom(static_cast<size_t>(r.second - r.first));
+    }
+    std::vector<size_t, SizeAlloc> sample(SizeAlloc(runs.get_allocator()));
+    sample.reserve(samples);
+    for (const auto& r : runs) {
+        size_t len = static_cast<size_t>(r.second - r.first);
+        size_t take = takeFrom(len);
+        for (size_t s = 0; s < take; ++s) {
+            sample.push_back(r.first[s * len / take]);
+        }
+    }
+    std::sort(sample.begin(), sample.end(), less);
+
+    // cuts[p * k + r] = first position of run r that belongs to part p
+    std::vector<const size_t*, CutAlloc> cuts((parts + 1) * k, nullptr, CutAlloc(runs.get_allocator()));
+    for (size_t r = 0; r < k; ++r) {
+        cuts[r] = runs[r].first;
+        cuts[parts * k + r] = runs[r].second;
+    }
+    for (size_t p = 1; p < parts; ++p) {
+        size_t splitter = sample[p * sample.size() / parts];
+        for (size_t r = 0; r < k; ++r) {
+            cuts[p * k + r] = std::lower_bound(runs[r].first, runs[r].second, splitter, less);
+        }
+    }
+
+    // Part p merges slices[p * k, (p + 1) * k) into out + offsets[p], using its own tree
+    std::vector<size_t, SizeAlloc> offsets(parts + 1, 0, SizeAlloc(runs.get_allocator()));
+    std::vector<IndexRun, RunAlloc> slices(parts * k, IndexRun(), runs.get_allocator());
+    for (size_t p = 0; p < parts; ++p) {
+        size_t len = 0;
+        for (size_t r = 0; r < k; ++r) {
+            slices[p * k + r] = IndexRun(cuts[p * k + r], cuts[(p + 1) * k + r]);
+            len += static_cast<size_t>(cuts[(p + 1) * k + r] - cuts[p * k + r]);
+        }
+        offsets[p + 1] = offsets[p] + len;
+    }
+    size_t leaves = detail::treeLeaves(k);
+    std::vector<size_t, SizeAlloc> losers(parts * leaves, 0, SizeAlloc(runs.get_allocator()));
+
+    pool.run(parts, [&](size_t p) {
+        detail::loserTreeMergeInto(slices.data() + p * k, k, out + offsets[p], less, losers.data() + p * leaves);
+    });
+}
+
+} // namespace parallel
+} // namespace container
+
+#endif // MULTIWAYMERGE_HPP
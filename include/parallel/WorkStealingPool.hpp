@@ -0,0 +1,229 @@
+// eitan.derdiger@gmail.com
+
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  WorkStealingPool.hpp defines a small fixed-size thread pool used by the parallel
+  algorithms of MyContainer<T> (parallel_for_each, parallel_reduce, ...).
+
+  run(chunks, body) executes body(c) for every chunk c in [0, chunks) and blocks until
+  all of them are done:
+    - Chunks are split into contiguous blocks, one block per participant
+      (every worker plus the calling thread).
+    - A participant takes chunks from the front of its own block, in order.
+    - When its block is empty it steals from the back of another participant's block,
+      so uneven chunk costs are balanced without a central queue.
+    - If a body throws, remaining chunks are skipped and the first exception is
+      rethrown by run().
+
+  Notes:
+    - run() calls from different threads are serialized.
+    - A run() issued from inside a body (by the caller or a worker, e.g. a lazily built
+      sorted permutation merging its runs) executes its chunks inline, in order, on the
+      calling thread instead of waiting for the busy pool.
+*/
+
+namespace container {
+namespace parallel {
+
+class WorkStealingPool {
+public:
+    /**
+     * @param workers Number of background threads (default = hardware concurrency - 1,
+     *        since the calling thread also participates).
+     */
+    explicit WorkStealingPool(size_t workers = defaultWorkers()) {
+        threads.reserve(workers);
+        for (size_t w = 0; w < workers; ++w) {
+            threads.emplace_back([this, w] { workerLoop(w); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    // Number of threads that execute chunks during run(), including the caller.
+    size_t participants() const noexcept {
+        return threads.size() + 1;
+    }
+
+    // Process-wide pool shared by the container algorithms.
+    static WorkStealingPool& shared() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    // True on a thread that is executing a body of this pool (run() then runs inline).
+    bool inBody() const noexcept {
+        return servingPool() == this;
+    }
+
+    // Executes body(c) for every c in [0, chunks); returns when all chunks are done.
+    template<typename Fn>
+    void run(size_t chunks, Fn&& body) {
+        if (chunks == 0) return;
+        if (inBody()) {
+            for (size_t c = 0; c < chunks; ++c) {
+                body(c);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> runLock(runMutex);
+
+        Job job(participants(), chunks, std::function<void(size_t)>(std::forward<Fn>(body)));
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            current = &job;
+            ++generation;
+        }
+        wake.notify_all();
+
+        servingPool() = this;
+        participate(job, threads.size());  // The caller is the last participant
+        servingPool() = nullptr;
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        done.wait(lock, [&] { return job.busyWorkers == 0; });
+        current = nullptr;
+        lock.unlock();
+
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    // One participant's block of chunk ids; the owner pops the front, thieves the back.
+    struct Block {
+        std::mutex m;
+        std::deque<size_t> chunks;
+    };
+
+    struct Job {
+        std::vector<Block> blocks;
+        std::function<void(size_t)> body;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        size_t busyWorkers = 0;  // Guarded by stateMutex
+
+        Job(size_t participants, size_t chunks, std::function<void(size_t)> fn)
+            : blocks(participants), body(std::move(fn)) {
+            for (size_t p = 0; p < participants; ++p) {
+                size_t first = chunks * p / participants;
+                size_t last = chunks * (p + 1) / participants;
+                for (size_t c = first; c < last; ++c) {
+                    blocks[p].chunks.push_back(c);
+                }
+            }
+        }
+    };
+
+    // The pool whose body the calling thread is executing, if any.
+    static const WorkStealingPool*& servingPool() noexcept {
+        thread_local const WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t defaultWorkers() {
+        size_t hw = std::thread::hardware_concurrency();
+        return hw > 1 ? hw - 1 : 0;
+    }
+
+    // Pops from the front of our own block, otherwise steals from the back of another.
+    static bool nextChunk(Job& job, size_t self, size_t& chunk) {
+        {
+            Block& own = job.blocks[self];
+            std::lock_guard<std::mutex> lock(own.m);
+            if (!own.chunks.empty()) {
+                chunk = own.chunks.front();
+                own.chunks.pop_front();
+                return true;
+            }
+        }
+        size_t n = job.blocks.size();
+        for (size_t k = 1; k < n; ++k) {
+            Block& victim = job.blocks[(self + k) % n];
+            std::lock_guard<std::mutex> lock(victim.m);
+            if (!victim.chunks.empty()) {
+                chunk = victim.chunks.back();
+                victim.chunks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void participate(Job& job, size_t self) {
+        size_t chunk = 0;
+        while (!job.failed.load(std::memory_order_relaxed) && nextChunk(job, self, chunk)) {
+            try {
+                job.body(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.errorMutex);
+                if (!job.error) {
+                    job.error = std::current_exception();
+                }
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void workerLoop(size_t self) {
+        servingPool() = this;  // Workers only ever execute bodies of this pool
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || (current && generation != seen); });
+            if (stopping) return;
+            seen = generation;
+            Job* job = current;
+            ++job->busyWorkers;
+            lock.unlock();
+
+            participate(*job, self);
+
+            lock.lock();
+            if (--job->busyWorkers == 0) {
+                done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex runMutex;    // Serializes run() calls
+    std::mutex stateMutex;  // Guards current, generation, stopping and Job::busyWorkers
+    std::condition_variable wake;
+    std::condition_variable done;
+    Job* current = nullptr;
+    size_t generation = 0;
+    bool stopping = false;
+};
+
+} // namespace parallel
+} // namespace container
+
+#endif // WORKSTEALINGPOOL_HPP
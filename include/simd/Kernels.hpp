@@ -0,0 +1,476 @@
+// eitan.derdiger@gmail.com
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MYCONTAINER_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+  Kernels.hpp provides the vectorized scans used by MyContainer<T> for arithmetic
+  element types:
+
+    - simd::find(data, n, value):      index of the first element == value, or n.
+    - simd::count(data, n, value):     number of elements == value.
+    - simd::removeAll(data, n, value): compacts the elements != value to the front
+                                       (keeping their order) and returns how many remain.
+
+  int32_t, uint32_t and float use AVX2 (8 lanes) or SSE2 (4 lanes) on x86, chosen at run
+  time from the CPU's feature flags; every other type, and every other CPU, takes the
+  scalar std:: algorithm. Float comparisons follow operator== (NaN never matches,
+  -0.0 matches +0.0).
+
+  Single-pass reductions (n > 0):
+
+    - simd::minmax(data, n): smallest and largest element (by operator<).
+    - simd::sum(data, n):    sum in SumType<T> (64-bit for integers, at least double
+                             for floating point), so int32 sums do not overflow.
+
+  int32_t, float and double reduce with AVX2 when available; other types use scalar
+  loops. With NaN in floating-point data the extremes are unspecified, as for sorting,
+  and vector sums may differ from a sequential sum in the last bits.
+*/
+
+namespace container {
+namespace simd {
+
+namespace detail {
+
+// 32-bit element types with a vector kernel; integers compare bitwise, floats as floats.
+// Only int32_t and uint32_t may be read through int32_t* (other 4-byte integers such as
+// char32_t or wchar_t would break strict aliasing), so those take the scalar path.
+template<typename T>
+constexpr bool isInt32Like = std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t>;
+template<typename T>
+constexpr bool isFloat = std::is_same_v<T, float>;
+
+#ifdef MYCONTAINER_SIMD_X86
+
+enum class Isa { Scalar, Sse2, Avx2 };
+
+inline Isa detectIsa() {
+    static const Isa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+        if (__builtin_cpu_supports("sse2")) return Isa::Sse2;
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+// permuteTable[mask] lists the lanes whose bit is set in mask, packed to the front.
+inline const std::array<std::array<int32_t, 8>, 256>& permuteTable() {
+    alignas(32) static const std::array<std::array<int32_t, 8>, 256> table = [] {
+        std::array<std::array<int32_t, 8>, 256> t{};
+        for (int mask = 0; mask < 256; ++mask) {
+            int out = 0;
+            for (int lane = 0; lane < 8; ++lane) {
+                if (mask & (1 << lane)) t[mask][out++] = lane;
+            }
+            for (; out < 8; ++out) t[mask][out] = 0;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Equality masks: one bit per lane (bit set = lane equals value).
+__attribute__((target("avx2"))) inline int eqMask8(const int32_t* p, __m256i v) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, v)));
+}
+__attribute__((target("avx2"))) inline int eqMask8(const float* p, __m256 v) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p), v, _CMP_EQ_OQ));
+}
+inline int eqMask4(const int32_t* p, __m128i v) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, v)));
+}
+inline int eqMask4(const float* p, __m128 v) {
+    return _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p), v));
+}
+
+__attribute__((target("avx2"))) inline __m256i splat8(int32_t x) { return _mm256_set1_epi32(x); }
+__attribute__((target("avx2"))) inline __m256 splat8(float x) { return _mm256_set1_ps(x); }
+inline __m128i splat4(int32_t x) { return _mm_set1_epi32(x); }
+inline __m128 splat4(float x) { return _mm_set1_ps(x); }
+
+template<typename E>
+__attribute__((target("avx2"))) size_t findAvx2(const E* p, size_t n, E value) {
+    auto v = splat8(value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (int m = eqMask8(p + i, v)) return i + static_cast<size_t>(__builtin_ctz(m));
+    }
+    for (; i < n; ++i) {
+        if (p[i] == value) return i;
+    }
+    return n;
+}
+
+template<typename E>
+size_t findSse2(const E* p, size_t n, E value) {
+    auto v = splat4(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        if (int m = eqMask4(p + i, v)) return i + static_cast<size_t>(__builtin_ctz(m));
+    }
+    for (; i < n; ++i) {
+        if (p[i] == value) return i;
+    }
+    return n;
+}
+
+template<typename E>
+__attribute__((target("avx2"))) size_t countAvx2(const E* p, size_t n, E value) {
+    auto v = splat8(value);
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        total += static_cast<size_t>(__builtin_popcount(eqMask8(p + i, v)));
+    }
+    for (; i < n; ++i) {
+        total += (p[i] == value);
+    }
+    return total;
+}
+
+template<typename E>
+size_t countSse2(const E* p, size_t n, E value) {
+    auto v = splat4(value);
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        total += static_cast<size_t>(__builtin_popcount(eqMask4(p + i, v)));
+    }
+    for (; i < n; ++i) {
+        total += (p[i] == value);
+    }
+    return total;
+}
+
+// Left-packs the kept lanes of each 8-element block with a lane permutation.
+// Writing at w <= i only overwrites lanes that were already loaded.
+template<typename E>
+__attribute__((target("avx2"))) size_t removeAvx2(E* p, size_t n, E value) {
+    const auto& table = permuteTable();
+    auto v = splat8(value);
+    size_t w = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int keep = ~eqMask8(p + i, v) & 0xFF;
+        __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table[keep].data()));
+        if constexpr (std::is_same_v<E, float>) {
+            _mm256_storeu_ps(p + w, _mm256_permutevar8x32_ps(_mm256_loadu_ps(p + i), perm));
+        } else {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + w),
+                                _mm256_permutevar8x32_epi32(x, perm));
+        }
+        w += static_cast<size_t>(__builtin_popcount(keep));
+    }
+    for (; i < n; ++i) {
+        p[w] = p[i];
+        w += !(p[i] == value);
+    }
+    return w;
+}
+
+#endif // MYCONTAINER_SIMD_X86
+
+// Branch-free scalar compaction for the 32-bit kernels without AVX2.
+template<typename E>
+size_t removeScalar(E* p, size_t n, E value) {
+    size_t w = 0;
+    for (size_t i = 0; i < n; ++i) {
+        E x = p[i];
+        p[w] = x;
+        w += !(x == value);
+    }
+    return w;
+}
+
+// Reinterprets uint32_t as int32_t (its signed counterpart, which may alias it) so one
+// kernel serves both; the kernels only test equality, so signedness does not matter.
+template<typename T>
+auto asKernelType(T* p) {
+    if constexpr (isFloat<std::remove_const_t<T>>) {
+        return p;
+    } else if constexpr (std::is_const_v<T>) {
+        return reinterpret_cast<const int32_t*>(p);
+    } else {
+        return reinterpret_cast<int32_t*>(p);
+    }
+}
+
+template<typename T>
+auto asKernelValue(T value) {
+    if constexpr (isFloat<T>) {
+        return value;
+    } else {
+        int32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
+
+#ifdef MYCONTAINER_SIMD_X86
+
+__attribute__((target("avx2"))) inline std::pair<int32_t, int32_t>
+minmaxAvx2(const int32_t* p, size_t n) {
+    __m256i lo = _mm256_set1_epi32(p[0]);
+    __m256i hi = lo;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        lo = _mm256_min_epi32(lo, x);
+        hi = _mm256_max_epi32(hi, x);
+    }
+    alignas(32) int32_t l[8], h[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(l), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(h), hi);
+    std::pair<int32_t, int32_t> r(l[0], h[0]);
+    for (int k = 1; k < 8; ++k) {
+        r.first = std::min(r.first, l[k]);
+        r.second = std::max(r.second, h[k]);
+    }
+    for (; i < n; ++i) {
+        r.first = std::min(r.first, p[i]);
+        r.second = std::max(r.second, p[i]);
+    }
+    return r;
+}
+
+__attribute__((target("avx2"))) inline std::pair<float, float>
+minmaxAvx2(const float* p, size_t n) {
+    __m256 lo = _mm256_set1_ps(p[0]);
+    __m256 hi = lo;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(p + i);
+        lo = _mm256_min_ps(lo, x);
+        hi = _mm256_max_ps(hi, x);
+    }
+    alignas(32) float l[8], h[8];
+    _mm256_store_ps(l, lo);
+    _mm256_store_ps(h, hi);
+    std::pair<float, float> r(l[0], h[0]);
+    for (int k = 1; k < 8; ++k) {
+        r.first = std::min(r.first, l[k]);
+        r.second = std::max(r.second, h[k]);
+    }
+    for (; i < n; ++i) {
+        r.first = std::min(r.first, p[i]);
+        r.second = std::max(r.second, p[i]);
+    }
+    return r;
+}
+
+__attribute__((target("avx2"))) inline std::pair<double, double>
+minmaxAvx2(const double* p, size_t n) {
+    __m256d lo = _mm256_set1_pd(p[0]);
+    __m256d hi = lo;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(p + i);
+        lo = _mm256_min_pd(lo, x);
+        hi = _mm256_max_pd(hi, x);
+    }
+    alignas(32) double l[4], h[4];
+    _mm256_store_pd(l, lo);
+    _mm256_store_pd(h, hi);
+    std::pair<double, double> r(l[0], h[0]);
+    for (int k = 1; k < 4; ++k) {
+        r.first = std::min(r.first, l[k]);
+        r.second = std::max(r.second, h[k]);
+    }
+    for (; i < n; ++i) {
+        r.first = std::min(r.first, p[i]);
+        r.second = std::max(r.second, p[i]);
+    }
+    return r;
+}
+
+// int32 lanes are widened to int64 before adding, so the sum cannot overflow.
+__attribute__((target("avx2"))) inline long long sumAvx2(const int32_t* p, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 4));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(a));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(b));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    long long total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        total += p[i];
+    }
+    return total;
+}
+
+// float lanes are widened to double before adding.
+__attribute__((target("avx2"))) inline double sumAvx2(const float* p, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(p + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(p + i + 4)));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        total += p[i];
+    }
+    return total;
+}
+
+__attribute__((target("avx2"))) inline double sumAvx2(const double* p, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(p + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(p + i + 4));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        total += p[i];
+    }
+    return total;
+}
+
+#endif // MYCONTAINER_SIMD_X86
+
+// Element types with vectorized reductions.
+template<typename T>
+constexpr bool hasVectorReduction =
+    std::is_same_v<T, int32_t> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+} // namespace detail
+
+/*
+  Accumulator type of simd::sum(): 64-bit integers for integral T, the wider of T and
+  double for floating-point T, and T itself for non-arithmetic types.
+*/
+template<typename T>
+using SumType = std::conditional_t<
+    std::is_integral_v<T>,
+    std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>,
+    std::conditional_t<std::is_floating_point_v<T>,
+                       std::conditional_t<(sizeof(T) > sizeof(double)), T, double>, T>>;
+
+// Name of the instruction set the 32-bit kernels run with on this CPU.
+inline const char* activeIsa() {
+#ifdef MYCONTAINER_SIMD_X86
+    switch (detail::detectIsa()) {
+        case detail::Isa::Avx2: return "avx2";
+        case detail::Isa::Sse2: return "sse2";
+        default: break;
+    }
+#endif
+    return "scalar";
+}
+
+template<typename T>
+size_t find(const T* data, size_t n, const T& value) {
+    if constexpr (detail::isInt32Like<T> || detail::isFloat<T>) {
+#ifdef MYCONTAINER_SIMD_X86
+        auto p = detail::asKernelType(data);
+        auto v = detail::asKernelValue(value);
+        switch (detail::detectIsa()) {
+            case detail::Isa::Avx2: return detail::findAvx2(p, n, v);
+            case detail::Isa::Sse2: return detail::findSse2(p, n, v);
+            default: break;
+        }
+#endif
+    }
+    return static_cast<size_t>(std::find(data, data + n, value) - data);
+}
+
+template<typename T>
+size_t count(const T* data, size_t n, const T& value) {
+    if constexpr (detail::isInt32Like<T> || detail::isFloat<T>) {
+#ifdef MYCONTAINER_SIMD_X86
+        auto p = detail::asKernelType(data);
+        auto v = detail::asKernelValue(value);
+        switch (detail::detectIsa()) {
+            case detail::Isa::Avx2: return detail::countAvx2(p, n, v);
+            case detail::Isa::Sse2: return detail::countSse2(p, n, v);
+            default: break;
+        }
+#endif
+    }
+    return static_cast<size_t>(std::count(data, data + n, value));
+}
+
+template<typename T>
+size_t removeAll(T* data, size_t n, const T& value) {
+    if constexpr (detail::isInt32Like<T> || detail::isFloat<T>) {
+        auto p = detail::asKernelType(data);
+        auto v = detail::asKernelValue(value);
+#ifdef MYCONTAINER_SIMD_X86
+        if (detail::detectIsa() == detail::Isa::Avx2) {
+            return detail::removeAvx2(p, n, v);
+        }
+#endif
+        return detail::removeScalar(p, n, v);
+    } else {
+        return static_cast<size_t>(std::remove(data, data + n, value) - data);
+    }
+}
+
+template<typename T>
+std::pair<T, T> minmax(const T* data, size_t n) {
+#ifdef MYCONTAINER_SIMD_X86
+    if constexpr (detail::hasVectorReduction<T>) {
+        if (detail::detectIsa() == detail::Isa::Avx2) {
+            return detail::minmaxAvx2(data, n);
+        }
+    }
+#endif
+    std::pair<T, T> r(data[0], data[0]);
+    for (size_t i = 1; i < n; ++i) {
+        if (data[i] < r.first) r.first = data[i];
+        if (r.second < data[i]) r.second = data[i];
+    }
+    return r;
+}
+
+template<typename T>
+SumType<T> sum(const T* data, size_t n) {
+    static_assert(std::is_arithmetic_v<T>, "sum() requires an arithmetic element type");
+#ifdef MYCONTAINER_SIMD_X86
+    if constexpr (detail::hasVectorReduction<T>) {
+        if (detail::detectIsa() == detail::Isa::Avx2) {
+            return detail::sumAvx2(data, n);
+        }
+    }
+#endif
+    SumType<T> total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += data[i];
+    }
+    return total;
+}
+
+} // namespace simd
+} // namespace container
+
+#endif // KERNELS_HPP
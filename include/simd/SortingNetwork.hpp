@@ -0,0 +1,290 @@
+// eitan.derdiger@gmail.com
+
+#ifndef SORTINGNETWORK_HPP
+#define SORTINGNETWORK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "Kernels.hpp"
+
+/*
+  SortingNetwork.hpp sorts index sequences by arithmetic keys without the
+  data-dependent branches of std::sort.
+
+  sortIndicesSmall(keys, first, last):
+    - Sorts the indices in [first, last) so that keys[index] ascends; ties keep index
+      order (the result is the stable order).
+    - Handles up to SmallSortMax (64) indices.
+
+  sortIndicesLeaves(keys, first, last, scratch) uses the network as the base case of
+  longer sorts: it sorts every 64-index leaf with the network, then merges the leaves
+  pairwise with a branch-free merge (ping-ponging through scratch). Ties break by
+  index value, which is the stable order whenever [first, last) ascends on entry.
+
+  Each key of at most 32 bits is mapped to an order-preserving unsigned code and packed
+  with its position into one 64-bit word, (code << 32) | position, so comparing words
+  compares keys and breaks ties by position. The words are then sorted:
+
+    - With AVX2, by a bitonic sorting network held entirely in sixteen 256-bit
+      registers (64 lanes, padded with sentinel words that sort last). Every
+      compare-exchange is a 64-bit compare and two blends, and the sequence of steps
+      depends only on the lane count, so nothing can be mispredicted.
+    - Otherwise by std::sort on the words, which still avoids the indirect key loads
+      of an index sort.
+
+  Wider keys (int64, double) fall back to a stable index sort. NaN keys are coded with
+  their sign bit cleared, so every NaN sorts after +infinity.
+
+  useSortingNetwork<K>(n) tells MyContainer when the network is worth it. The network
+  always does the full 64-lane amount of work, and on AVX2 hardware it beats std::sort
+  only from about 50 elements (about 2.5x at 64), so it is chosen for keys of at most
+  32 bits and NetworkMin..SmallSortMax elements. Beyond SmallSortMax, leaves plus merges
+  beat an index std::sort by about 2x (see bench/bench_sort.cpp), so useNetworkLeaves<K>(n)
+  picks sortIndicesLeaves() for every longer range of such keys.
+*/
+
+namespace container {
+namespace simd {
+
+constexpr size_t SmallSortMax = 64;
+constexpr size_t NetworkMin = 50;
+
+namespace detail {
+
+// Maps a key to an unsigned code with the same ordering (floats: sign-magnitude flip,
+// with the sign bit of NaN cleared so that every NaN sorts last).
+template<typename K>
+uint64_t orderCode(K key) {
+    if constexpr (std::is_floating_point_v<K>) {
+        using Bits = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+        Bits bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        const Bits sign = Bits(1) << (sizeof(Bits) * 8 - 1);
+        if (key != key) {
+            bits &= ~sign;  // A positive NaN's bits exceed +infinity's
+        }
+        return (bits & sign) ? ~bits : (bits | sign);
+    } else if constexpr (std::is_signed_v<K>) {
+        using U = std::make_unsigned_t<K>;
+        return static_cast<uint64_t>(static_cast<U>(key) ^ (U(1) << (sizeof(K) * 8 - 1)));
+    } else {
+        return static_cast<uint64_t>(key);
+    }
+}
+
+#ifdef MYCONTAINER_SIMD_X86
+
+constexpr size_t NetworkRegs = SmallSortMax / 4;
+
+/*
+  One step of the bitonic network over R registers of four 64-bit lanes: merge blocks
+  of K lanes with compare distance J, then recurse into the next register (Q + 1) or
+  the next distance (J / 2). Lane l of register q is element 4q + l; a block sorts up
+  when (4q & K) == 0. Words are compared as signed after flipping the top bit.
+*/
+template<size_t R, size_t K, size_t J, size_t Q = 0>
+__attribute__((target("avx2"), always_inline)) inline void bitonicStep(__m256i* r) {
+    if constexpr (Q < R) {
+        constexpr bool up = ((4 * Q) & K) == 0;
+        if constexpr (J >= 4) {
+            // Partner lanes live in another register
+            constexpr size_t D = J / 4;
+            if constexpr ((Q & D) == 0) {
+                __m256i a = r[Q], b = r[Q + D];
+                __m256i gt = _mm256_cmpgt_epi64(a, b);
+                __m256i lo = _mm256_blendv_epi8(a, b, gt);
+                __m256i hi = _mm256_blendv_epi8(b, a, gt);
+                r[Q] = up ? lo : hi;
+                r[Q + D] = up ? hi : lo;
+            }
+        } else {
+            // Partner lanes live in the same register: swap them in, keep min or max
+            __m256i v = r[Q];
+            __m256i p = J == 2 ? _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2))
+                               : _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 3, 0, 1));
+            __m256i gt = _mm256_cmpgt_epi64(v, p);
+            __m256i lo = _mm256_blendv_epi8(v, p, gt);
+            __m256i hi = _mm256_blendv_epi8(p, v, gt);
+            if constexpr (K == 2) {
+                r[Q] = _mm256_blend_epi32(lo, hi, 0x3C);  // Lanes 0-1 up, 2-3 down
+            } else if constexpr (J == 2) {
+                r[Q] = up ? _mm256_blend_epi32(lo, hi, 0xF0) : _mm256_blend_epi32(hi, lo, 0xF0);
+            } else {
+                r[Q] = up ? _mm256_blend_epi32(lo, hi, 0xCC) : _mm256_blend_epi32(hi, lo, 0xCC);
+            }
+        }
+        bitonicStep<R, K, J, Q + 1>(r);
+    } else if constexpr (J > 1) {
+        bitonicStep<R, K, J / 2>(r);
+    }
+}
+
+template<size_t R, size_t K>
+__attribute__((target("avx2"), always_inline)) inline void bitonicPhases(__m256i* r) {
+    bitonicStep<R, K, K / 2>(r);
+    if constexpr (K < 4 * R) {
+        bitonicPhases<R, 2 * K>(r);
+    }
+}
+
+// Sorts 64 signed 64-bit words in place (p must be 32-byte aligned).
+__attribute__((target("avx2"))) inline void bitonicSort64(int64_t* p) {
+    __m256i r[NetworkRegs];
+    for (size_t q = 0; q < NetworkRegs; ++q) {
+        r[q] = _mm256_load_si256(reinterpret_cast<const __m256i*>(p + 4 * q));
+    }
+    bitonicPhases<NetworkRegs, 2>(r);
+    for (size_t q = 0; q < NetworkRegs; ++q) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 4 * q), r[q]);
+    }
+}
+
+#endif // MYCONTAINER_SIMD_X86
+
+inline bool networkAvailable() {
+#ifdef MYCONTAINER_SIMD_X86
+    return detectIsa() == Isa::Avx2;
+#else
+    return false;
+#endif
+}
+
+} // namespace detail
+
+// True if MyContainer should sort n indices over keys of type K with sortIndicesSmall().
+template<typename K>
+bool useSortingNetwork(size_t n) {
+    if constexpr (std::is_arithmetic_v<K> && !std::is_same_v<K, bool> && sizeof(K) <= 4) {
+        return n >= NetworkMin && n <= SmallSortMax && detail::networkAvailable();
+    } else {
+        return false;
+    }
+}
+
+// True if MyContainer should sort n indices over keys of type K with sortIndicesLeaves().
+template<typename K>
+bool useNetworkLeaves(size_t n) {
+    if constexpr (std::is_arithmetic_v<K> && !std::is_same_v<K, bool> && sizeof(K) <= 4) {
+        return n > SmallSortMax && detail::networkAvailable();
+    } else {
+        return false;
+    }
+}
+
+template<typename K>
+void sortIndicesSmall(const K* keys, size_t* first, size_t* last) {
+    size_t n = static_cast<size_t>(last - first);
+    if (n < 2) return;
+
+    if constexpr (sizeof(K) <= 4) {
+        alignas(32) uint64_t packed[SmallSortMax];
+        for (size_t i = 0; i < n; ++i) {
+            packed[i] = (detail::orderCode(keys[first[i]]) << 32) | i;
+        }
+#ifdef MYCONTAINER_SIMD_X86
+        if (detail::networkAvailable()) {
+            // Sentinels keep the largest code and a position past n, so they sort last
+            constexpr uint64_t signBit = uint64_t(1) << 63;
+            for (size_t i = n; i < SmallSortMax; ++i) {
+                packed[i] = (uint64_t(0xFFFFFFFFu) << 32) | i;
+            }
+            for (size_t i = 0; i < SmallSortMax; ++i) {
+                packed[i] ^= signBit;  // Unsigned order as signed 64-bit compares
+            }
+            detail::bitonicSort64(reinterpret_cast<int64_t*>(packed));
+            for (size_t i = 0; i < n; ++i) {
+                packed[i] ^= signBit;
+            }
+        } else
+#endif
+        {
+            std::sort(packed, packed + n);
+        }
+        size_t original[SmallSortMax];
+        std::copy(first, last, original);
+        for (size_t i = 0; i < n; ++i) {
+            first[i] = original[packed[i] & 0xFFFFFFFFu];
+        }
+    } else {
+        std::stable_sort(first, last, [&](size_t a, size_t b) {
+            return detail::orderCode(keys[a]) < detail::orderCode(keys[b]);
+        });
+    }
+}
+
+/*
+  Sorts [first, last) as described above. Every index must be below 2^32 and scratch
+  must hold last - first words; the packed words are built in [first, last) itself.
+  Wider keys fall back to a stable index sort, as in sortIndicesSmall().
+*/
+template<typename K>
+void sortIndicesLeaves(const K* keys, size_t* first, size_t* last, size_t* scratch) {
+    if constexpr (sizeof(K) > 4) {
+        std::stable_sort(first, last, [&](size_t a, size_t b) {
+            return detail::orderCode(keys[a]) < detail::orderCode(keys[b]);
+        });
+        (void)scratch;
+    } else {
+        static_assert(sizeof(size_t) == sizeof(uint64_t), "Indices are packed into 64-bit words");
+        size_t n = static_cast<size_t>(last - first);
+        for (size_t i = 0; i < n; ++i) {
+            first[i] = static_cast<size_t>((detail::orderCode(keys[first[i]]) << 32) | first[i]);
+        }
+
+        for (size_t leaf = 0; leaf < n; leaf += SmallSortMax) {
+            size_t m = std::min(SmallSortMax, n - leaf);
+#ifdef MYCONTAINER_SIMD_X86
+            if (detail::networkAvailable()) {
+                // Sentinels are the largest word, so they sort last; equal real words are
+                // indistinguishable from them
+                constexpr uint64_t signBit = uint64_t(1) << 63;
+                alignas(32) uint64_t packed[SmallSortMax];
+                for (size_t i = 0; i < SmallSortMax; ++i) {
+                    packed[i] = (i < m ? first[leaf + i] : ~uint64_t(0)) ^ signBit;
+                }
+                detail::bitonicSort64(reinterpret_cast<int64_t*>(packed));
+                for (size_t i = 0; i < m; ++i) {
+                    first[leaf + i] = static_cast<size_t>(packed[i] ^ signBit);
+                }
+                continue;
+            }
+#endif
+            std::sort(first + leaf, first + leaf + m);
+        }
+
+        // Bottom-up merges; the loop selects with arithmetic instead of a branch per word
+        size_t* src = first;
+        size_t* dst = scratch;
+        for (size_t width = SmallSortMax; width < n; width *= 2) {
+            for (size_t begin = 0; begin < n; begin += 2 * width) {
+                size_t mid = std::min(n, begin + width);
+                size_t end = std::min(n, begin + 2 * width);
+                size_t i = begin;
+                size_t j = mid;
+                size_t o = begin;
+                while (i < mid && j < end) {
+                    size_t a = src[i];
+                    size_t b = src[j];
+                    bool takeB = b < a;
+                    dst[o++] = takeB ? b : a;
+                    i += !takeB;
+                    j += takeB;
+                }
+                o = static_cast<size_t>(std::copy(src + i, src + mid, dst + o) - dst);
+                std::copy(src + j, src + end, dst + o);
+            }
+            std::swap(src, dst);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            first[i] = src[i] & 0xFFFFFFFFu;
+        }
+    }
+}
+
+} // namespace simd
+} // namespace container
+
+#endif // SORTINGNETWORK_HPP
@@ -0,0 +1,123 @@
+// eitan.derdiger@gmail.com
+
+#ifndef APPENDLOG_HPP
+#define APPENDLOG_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/*
+  AppendLog.hpp defines AppendLog<T, Alloc>, an append-only element log that one
+  writer grows while any number of readers read the elements already published.
+
+  Layout:
+    - Chunk k holds FirstChunkSize << k elements, so chunk sizes double and a fixed
+      table of MaxChunks pointers covers every index; index i lives in chunk
+      log2(i / FirstChunkSize + 1).
+    - Elements never move and the chunk table never reallocates, so a reader needs no
+      lock: size() is the published length (an acquire load) and every element below
+      it stays valid, unchanged, for the life of the log.
+
+  Writer side: push_back() constructs the element, then publishes the new length with
+  a release store. Only one thread may call push_back() at a time.
+*/
+
+namespace container {
+
+template<typename T, typename Alloc = std::allocator<T>>
+class AppendLog {
+    using Traits = std::allocator_traits<Alloc>;
+
+public:
+    static constexpr size_t FirstChunkBits = 12;
+    static constexpr size_t FirstChunkSize = size_t(1) << FirstChunkBits;
+    static constexpr size_t MaxChunks = sizeof(size_t) * 8 - FirstChunkBits;
+
+    explicit AppendLog(const Alloc& allocator = Alloc()) : alloc(allocator) {}
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    ~AppendLog() {
+        size_t n = published.load(std::memory_order_relaxed);
+        forEachChunk(0, n, [&](T* first, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                Traits::destroy(alloc, first + i);
+            }
+        });
+        for (size_t k = 0; k < MaxChunks; ++k) {
+            if (T* chunk = chunks[k].load(std::memory_order_relaxed)) {
+                Traits::deallocate(alloc, chunk, chunkSize(k));
+            }
+        }
+    }
+
+    // Number of published elements; all of them may be read without synchronization.
+    size_t size() const noexcept {
+        return published.load(std::memory_order_acquire);
+    }
+
+    const T& operator[](size_t i) const noexcept {
+        size_t k = chunkOf(i);
+        return chunks[k].load(std::memory_order_relaxed)[i - chunkStart(k)];
+    }
+
+    // Appends and publishes one element (single writer). On an exception nothing is
+    // published.
+    void push_back(const T& value) {
+        size_t n = published.load(std::memory_order_relaxed);
+        size_t k = chunkOf(n);
+        T* chunk = chunks[k].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = Traits::allocate(alloc, chunkSize(k));
+            chunks[k].store(chunk, std::memory_order_relaxed);  // Published with the length
+        }
+        Traits::construct(alloc, chunk + (n - chunkStart(k)), value);
+        published.store(n + 1, std::memory_order_release);
+    }
+
+    // Calls fn(const T* first, size_t count) for every contiguous piece of [from, to).
+    template<typename Fn>
+    void forEachSpan(size_t from, size_t to, Fn fn) const {
+        forEachChunk(from, to, [&](const T* first, size_t count) { fn(first, count); });
+    }
+
+    Alloc get_allocator() const noexcept {
+        return alloc;
+    }
+
+private:
+    Alloc alloc;
+    std::atomic<T*> chunks[MaxChunks] = {};
+    std::atomic<size_t> published{0};
+
+    static size_t chunkOf(size_t i) noexcept {
+        size_t q = (i >> FirstChunkBits) + 1;
+        return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(q));
+    }
+
+    static size_t chunkStart(size_t k) noexcept {
+        return ((size_t(1) << k) - 1) << FirstChunkBits;
+    }
+
+    static size_t chunkSize(size_t k) noexcept {
+        return FirstChunkSize << k;
+    }
+
+    template<typename Fn>
+    void forEachChunk(size_t from, size_t to, Fn fn) const {
+        while (from < to) {
+            size_t k = chunkOf(from);
+            size_t offset = from - chunkStart(k);
+            size_t n = std::min(chunkSize(k) - offset, to - from);
+            fn(chunks[k].load(std::memory_order_relaxed) + offset, n);
+            from += n;
+        }
+    }
+};
+
+} // namespace container
+
+#endif // APPENDLOG_HPP
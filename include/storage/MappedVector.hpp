@@ -0,0 +1,123 @@
+// eitan.derdiger@gmail.com
+
+#ifndef MAPPEDVECTOR_HPP
+#define MAPPEDVECTOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+  MappedVector.hpp defines MappedVector<T, Alloc>, the element buffer behind
+  MyContainer's MappedStorage policy.
+
+  A MappedVector either reads its elements straight out of a read-only region (for
+  example a file mapped by io::openMapped()) or owns a std::vector<T, Alloc>:
+    - Reads (size(), const operator[], data()) never copy.
+    - The first mutation (push_back, reserve, non-const access) copies the region into
+      an owned vector and releases the region; later mutations work on that vector.
+    - Copies share the region, so snapshots of a mapped container stay O(1).
+
+  The region is kept alive by a shared_ptr<const void> whose deleter unmaps it.
+  T must be trivially copyable, since elements are read in place from raw bytes.
+*/
+
+namespace container {
+
+template<typename T, typename Alloc = std::allocator<T>>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector needs a trivially copyable T");
+
+    using Owned = std::vector<T, Alloc>;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+
+    MappedVector() = default;
+
+    explicit MappedVector(const Alloc& allocator) : owned(allocator) {}
+
+    /**
+     * Views n elements at first, which must stay valid while region is alive.
+     */
+    MappedVector(std::shared_ptr<const void> region, const T* first, size_t n,
+                 const Alloc& allocator = Alloc())
+        : owned(allocator), region(std::move(region)), mapped(first), mappedCount(n) {}
+
+    MappedVector(const MappedVector& other)
+        : MappedVector(other, std::allocator_traits<Alloc>::select_on_container_copy_construction(
+                                  other.owned.get_allocator())) {}
+
+    MappedVector(const MappedVector& other, const Alloc& allocator)
+        : owned(other.owned, allocator), region(other.region), mapped(other.mapped),
+          mappedCount(other.mappedCount) {}
+
+    MappedVector(MappedVector&& other) noexcept
+        : owned(std::move(other.owned)), region(std::move(other.region)),
+          mapped(std::exchange(other.mapped, nullptr)), mappedCount(std::exchange(other.mappedCount, 0)) {}
+
+    MappedVector& operator=(const MappedVector&) = delete;
+    MappedVector& operator=(MappedVector&&) = delete;
+
+    size_t size() const noexcept {
+        return region ? mappedCount : owned.size();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    const T* data() const noexcept {
+        return region ? mapped : owned.data();
+    }
+
+    const T& operator[](size_t i) const noexcept {
+        return data()[i];
+    }
+
+    T& operator[](size_t i) {
+        return materialize()[i];
+    }
+
+    void push_back(const T& value) {
+        materialize().push_back(value);
+    }
+
+    void reserve(size_t capacity) {
+        materialize().reserve(capacity);
+    }
+
+    // True while the elements are still read from the region.
+    bool isMapped() const noexcept {
+        return static_cast<bool>(region);
+    }
+
+    // Copies the region into the owned vector (once) and returns that vector.
+    Owned& materialize() {
+        if (region) {
+            owned.assign(mapped, mapped + mappedCount);
+            region.reset();
+            mapped = nullptr;
+            mappedCount = 0;
+        }
+        return owned;
+    }
+
+    Alloc get_allocator() const noexcept {
+        return owned.get_allocator();
+    }
+
+private:
+    Owned owned;
+    std::shared_ptr<const void> region;  // Null once materialized (or if never mapped)
+    const T* mapped = nullptr;
+    size_t mappedCount = 0;
+};
+
+} // namespace container
+
+#endif // MAPPEDVECTOR_HPP
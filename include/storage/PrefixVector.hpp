@@ -0,0 +1,132 @@
+// eitan.derdiger@gmail.com
+
+#ifndef PREFIXVECTOR_HPP
+#define PREFIXVECTOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "AppendLog.hpp"
+#include "SegmentedVector.hpp"
+
+/*
+  PrefixVector.hpp defines PrefixVector<T, Alloc>, the element buffer behind
+  MyContainer's PrefixStorage policy (the snapshots of VersionedContainer).
+
+  A PrefixVector either reads the first n elements of a shared AppendLog or owns a
+  SegmentedVector<T, Alloc>:
+    - Reads never copy; elements the writer appends to the log after the prefix was
+      taken are not visible.
+    - The first mutation copies the prefix into an owned SegmentedVector and releases
+      the log; later mutations work on that vector.
+    - Copies share the log, so copying a snapshot stays O(1).
+*/
+
+namespace container {
+
+template<typename T, typename Alloc = std::allocator<T>>
+class PrefixVector {
+    using Owned = SegmentedVector<T, Alloc>;
+
+public:
+    using Log = AppendLog<T, Alloc>;
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+
+    PrefixVector() = default;
+
+    explicit PrefixVector(const Alloc& allocator) : owned(allocator) {}
+
+    // Views elements [0, n) of log; n may exceed log->size() only until the writer has
+    // published those elements, and nothing may be read before then.
+    PrefixVector(std::shared_ptr<const Log> log, size_t n)
+        : owned(log->get_allocator()), log(std::move(log)), prefix(n) {}
+
+    PrefixVector(const PrefixVector& other)
+        : owned(other.owned), log(other.log), prefix(other.prefix) {}
+
+    PrefixVector(const PrefixVector& other, const Alloc& allocator)
+        : owned(other.owned, allocator), log(other.log), prefix(other.prefix) {}
+
+    PrefixVector(PrefixVector&& other) noexcept
+        : owned(std::move(other.owned)), log(std::move(other.log)), prefix(std::exchange(other.prefix, 0)) {}
+
+    PrefixVector& operator=(const PrefixVector&) = delete;
+    PrefixVector& operator=(PrefixVector&&) = delete;
+
+    size_t size() const noexcept {
+        return log ? prefix : owned.size();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    const T& operator[](size_t i) const noexcept {
+        return log ? (*log)[i] : owned[i];
+    }
+
+    T& operator[](size_t i) {
+        return materialize()[i];
+    }
+
+    void push_back(const T& value) {
+        materialize().push_back(value);
+    }
+
+    void reserve(size_t capacity) {
+        materialize().reserve(capacity);
+    }
+
+    void truncate(size_t n) {
+        materialize().truncate(n);
+    }
+
+    template<typename Fn>
+    void forEachSpan(size_t from, size_t to, Fn fn) const {
+        if (log) {
+            log->forEachSpan(from, to, fn);
+        } else {
+            owned.forEachSpan(from, to, fn);
+        }
+    }
+
+    // True while the elements are still read from the shared log.
+    bool isShared() const noexcept {
+        return static_cast<bool>(log);
+    }
+
+    // Copies the prefix into the owned vector (once) and returns that vector.
+    Owned& materialize() {
+        if (log) {
+            try {
+                owned.reserve(prefix);
+                log->forEachSpan(0, prefix, [&](const T* first, size_t n) {
+                    for (size_t i = 0; i < n; ++i) {
+                        owned.push_back(first[i]);
+                    }
+                });
+            } catch (...) {
+                owned.truncate(0);  // Still a view of the log
+                throw;
+            }
+            log.reset();
+            prefix = 0;
+        }
+        return owned;
+    }
+
+    Alloc get_allocator() const noexcept {
+        return owned.get_allocator();
+    }
+
+private:
+    Owned owned;
+    std::shared_ptr<const Log> log;  // Null once materialized (or if never shared)
+    size_t prefix = 0;
+};
+
+} // namespace container
+
+#endif // PREFIXVECTOR_HPP
@@ -0,0 +1,166 @@
+// eitan.derdiger@gmail.com
+
+#ifndef SEGMENTEDVECTOR_HPP
+#define SEGMENTEDVECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+  SegmentedVector.hpp defines SegmentedVector<T, Alloc>, the element buffer behind
+  MyContainer's SegmentedStorage policy.
+
+  Layout:
+    - Elements live in fixed-size chunks of ChunkSize (4096) elements; a small
+      directory of chunk pointers maps index i to chunk i / ChunkSize.
+    - Growing never moves or copies existing elements, so push_back() is O(1) in the
+      worst case apart from the directory (one pointer per chunk, so a directory
+      regrowth copies n / 4096 pointers) and element addresses stay stable.
+    - Chunks that become unused after truncate() are kept for later growth.
+
+  Interface (the subset of std::vector MyContainer needs):
+    - size(), empty(), operator[], push_back(), reserve(), truncate(n).
+    - forEachSpan(from, to, fn) calls fn(const T* first, size_t count) for every
+      contiguous piece of [from, to), in order, so vectorized kernels run per chunk.
+
+  Copies (with an optional allocator) copy element by element; assignment is not
+  supported, since MyContainer replaces whole buffers instead of assigning them.
+*/
+
+namespace container {
+
+template<typename T, typename Alloc = std::allocator<T>>
+class SegmentedVector {
+    using Traits = std::allocator_traits<Alloc>;
+    using ChunkList = std::vector<T*, typename Traits::template rebind_alloc<T*>>;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+
+    static constexpr size_t ChunkBits = 12;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Alloc& allocator)
+        : alloc(allocator), chunks(typename ChunkList::allocator_type(allocator)) {}
+
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(other, Traits::select_on_container_copy_construction(other.alloc)) {}
+
+    SegmentedVector(const SegmentedVector& other, const Alloc& allocator)
+        : SegmentedVector(allocator) {
+        try {
+            reserve(other.count);
+            other.forEachSpan(0, other.count, [&](const T* first, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    push_back(first[i]);
+                }
+            });
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : alloc(other.alloc), chunks(std::move(other.chunks)), count(other.count) {
+        other.chunks.clear();
+        other.count = 0;
+    }
+
+    SegmentedVector& operator=(const SegmentedVector&) = delete;
+    SegmentedVector& operator=(SegmentedVector&&) = delete;
+
+    ~SegmentedVector() {
+        release();
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    const T& operator[](size_t i) const noexcept {
+        return chunks[i >> ChunkBits][i & (ChunkSize - 1)];
+    }
+
+    T& operator[](size_t i) noexcept {
+        return chunks[i >> ChunkBits][i & (ChunkSize - 1)];
+    }
+
+    void push_back(const T& value) {
+        size_t c = count >> ChunkBits;
+        if (c == chunks.size()) {
+            addChunk();
+        }
+        Traits::construct(alloc, chunks[c] + (count & (ChunkSize - 1)), value);
+        ++count;
+    }
+
+    // Allocates chunks (and directory room) for at least capacity elements.
+    void reserve(size_t capacity) {
+        size_t needed = (capacity + ChunkSize - 1) >> ChunkBits;
+        chunks.reserve(needed);
+        while (chunks.size() < needed) {
+            addChunk();
+        }
+    }
+
+    // Destroys the elements from index n on; keeps their chunks for reuse.
+    void truncate(size_t n) noexcept {
+        while (count > n) {
+            --count;
+            Traits::destroy(alloc, &(*this)[count]);
+        }
+    }
+
+    template<typename Fn>
+    void forEachSpan(size_t from, size_t to, Fn fn) const {
+        while (from < to) {
+            size_t offset = from & (ChunkSize - 1);
+            size_t n = std::min(ChunkSize - offset, to - from);
+            fn(chunks[from >> ChunkBits] + offset, n);
+            from += n;
+        }
+    }
+
+    Alloc get_allocator() const noexcept {
+        return alloc;
+    }
+
+private:
+    Alloc alloc;
+    ChunkList chunks{typename ChunkList::allocator_type(alloc)};
+    size_t count = 0;
+
+    void addChunk() {
+        T* chunk = Traits::allocate(alloc, ChunkSize);
+        try {
+            chunks.push_back(chunk);
+        } catch (...) {
+            Traits::deallocate(alloc, chunk, ChunkSize);
+            throw;
+        }
+    }
+
+    void release() noexcept {
+        truncate(0);
+        for (T* chunk : chunks) {
+            Traits::deallocate(alloc, chunk, ChunkSize);
+        }
+        chunks.clear();
+    }
+};
+
+} // namespace container
+
+#endif // SEGMENTEDVECTOR_HPP
@@ -0,0 +1,180 @@
+// eitan.derdiger@gmail.com
+
+#ifndef STORAGEPOLICY_HPP
+#define STORAGEPOLICY_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "SegmentedVector.hpp"
+#include "MappedVector.hpp"
+#include "PrefixVector.hpp"
+#include "../simd/Kernels.hpp"
+
+/*
+  StoragePolicy.hpp defines the element-buffer policies of MyContainer<T, Alloc, Policy>:
+
+    - ContiguousStorage (default): one std::vector<T, Alloc>. Fastest scans and sorts,
+      but growth past capacity moves every element.
+    - SegmentedStorage: a SegmentedVector<T, Alloc> of fixed-size chunks. add() never
+      moves existing elements, at the cost of one extra indirection per access.
+    - MappedStorage: a MappedVector<T, Alloc> that reads a read-only region (a file
+      opened with io::openMapped()) in place and copies it on the first mutation.
+    - PrefixStorage: a PrefixVector<T, Alloc> that reads a published prefix of an
+      AppendLog (a VersionedContainer snapshot) and copies it on the first mutation.
+
+  The storage:: helpers give MyContainer one code path for both buffers:
+    - forEachSpan(buf, from, to, fn): fn(const T* first, size_t n) per contiguous piece.
+    - append(buf, first, last):       appends a range.
+    - removeAll(buf, value):          drops every element == value, keeping the order.
+    - eraseSlots(buf, dead):          drops every slot i with dead(i), keeping the order.
+*/
+
+namespace container {
+
+struct ContiguousStorage {
+    template<typename T, typename Alloc>
+    using Buffer = std::vector<T, Alloc>;
+    static constexpr bool contiguous = true;
+};
+
+struct SegmentedStorage {
+    template<typename T, typename Alloc>
+    using Buffer = SegmentedVector<T, Alloc>;
+    static constexpr bool contiguous = false;
+};
+
+struct MappedStorage {
+    template<typename T, typename Alloc>
+    using Buffer = MappedVector<T, Alloc>;
+    static constexpr bool contiguous = true;
+};
+
+struct PrefixStorage {
+    template<typename T, typename Alloc>
+    using Buffer = PrefixVector<T, Alloc>;
+    static constexpr bool contiguous = false;
+};
+
+namespace storage {
+
+template<typename T, typename Alloc, typename Fn>
+void forEachSpan(const std::vector<T, Alloc>& buf, size_t from, size_t to, Fn fn) {
+    if (from < to) {
+        fn(buf.data() + from, to - from);
+    }
+}
+
+template<typename T, typename Alloc, typename Fn>
+void forEachSpan(const SegmentedVector<T, Alloc>& buf, size_t from, size_t to, Fn fn) {
+    buf.forEachSpan(from, to, fn);
+}
+
+template<typename T, typename Alloc, typename It>
+void append(std::vector<T, Alloc>& buf, It first, It last) {
+    buf.insert(buf.end(), first, last);
+}
+
+template<typename T, typename Alloc, typename It>
+void append(SegmentedVector<T, Alloc>& buf, It first, It last) {
+    buf.reserve(buf.size() + static_cast<size_t>(std::distance(first, last)));
+    for (; first != last; ++first) {
+        buf.push_back(*first);
+    }
+}
+
+template<typename T, typename Alloc>
+void removeAll(std::vector<T, Alloc>& buf, const T& value) {
+    size_t kept = simd::removeAll(buf.data(), buf.size(), value);
+    buf.erase(buf.begin() + static_cast<std::ptrdiff_t>(kept), buf.end());
+}
+
+template<typename T, typename Alloc>
+void removeAll(SegmentedVector<T, Alloc>& buf, const T& value) {
+    // Stable compaction across chunks, then drop the tail
+    size_t kept = 0;
+    for (size_t i = 0; i < buf.size(); ++i) {
+        if (!(buf[i] == value)) {
+            if (kept != i) {
+                buf[kept] = buf[i];
+            }
+            ++kept;
+        }
+    }
+    buf.truncate(kept);
+}
+
+template<typename T, typename Alloc, typename Pred>
+void eraseSlots(std::vector<T, Alloc>& buf, Pred dead) {
+    size_t kept = 0;
+    for (size_t i = 0; i < buf.size(); ++i) {
+        if (!dead(i)) {
+            if (kept != i) {
+                buf[kept] = std::move(buf[i]);
+            }
+            ++kept;
+        }
+    }
+    buf.erase(buf.begin() + static_cast<std::ptrdiff_t>(kept), buf.end());
+}
+
+template<typename T, typename Alloc, typename Pred>
+void eraseSlots(SegmentedVector<T, Alloc>& buf, Pred dead) {
+    size_t kept = 0;
+    for (size_t i = 0; i < buf.size(); ++i) {
+        if (!dead(i)) {
+            if (kept != i) {
+                buf[kept] = std::move(buf[i]);
+            }
+            ++kept;
+        }
+    }
+    buf.truncate(kept);
+}
+
+template<typename T, typename Alloc, typename Fn>
+void forEachSpan(const MappedVector<T, Alloc>& buf, size_t from, size_t to, Fn fn) {
+    if (from < to) {
+        fn(buf.data() + from, to - from);
+    }
+}
+
+template<typename T, typename Alloc, typename It>
+void append(MappedVector<T, Alloc>& buf, It first, It last) {
+    append(buf.materialize(), first, last);
+}
+
+template<typename T, typename Alloc>
+void removeAll(MappedVector<T, Alloc>& buf, const T& value) {
+    removeAll(buf.materialize(), value);
+}
+
+template<typename T, typename Alloc, typename Pred>
+void eraseSlots(MappedVector<T, Alloc>& buf, Pred dead) {
+    eraseSlots(buf.materialize(), dead);
+}
+
+template<typename T, typename Alloc, typename Fn>
+void forEachSpan(const PrefixVector<T, Alloc>& buf, size_t from, size_t to, Fn fn) {
+    buf.forEachSpan(from, to, fn);
+}
+
+template<typename T, typename Alloc, typename It>
+void append(PrefixVector<T, Alloc>& buf, It first, It last) {
+    append(buf.materialize(), first, last);
+}
+
+template<typename T, typename Alloc>
+void removeAll(PrefixVector<T, Alloc>& buf, const T& value) {
+    removeAll(buf.materialize(), value);
+}
+
+template<typename T, typename Alloc, typename Pred>
+void eraseSlots(PrefixVector<T, Alloc>& buf, Pred dead) {
+    eraseSlots(buf.materialize(), dead);
+}
+
+} // namespace storage
+} // namespace container
+
+#endif // STORAGEPOLICY_HPP
@@ -0,0 +1,38 @@
+// eitan.derdiger@gmail.com
+
+#ifndef ALLOCCOUNTER_HPP
+#define ALLOCCOUNTER_HPP
+
+#include <cstddef>
+
+/*
+  AllocCounter.hpp exposes the allocation counters of the test_alloc executable. Its
+  test_alloc.cpp replaces every form of the global operator new / delete with counting
+  versions; the counters are per thread, so pool workers do not disturb a test.
+
+    - alloctest::counts(): the calling thread's running totals.
+    - alloctest::during(fn): the allocations, deallocations and bytes requested by fn().
+*/
+
+namespace alloctest {
+
+struct Counts {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes = 0;
+};
+
+Counts& counts() noexcept;
+
+template<typename Fn>
+Counts during(Fn&& fn) {
+    Counts before = counts();
+    fn();
+    Counts after = counts();
+    return Counts{after.allocations - before.allocations, after.deallocations - before.deallocations,
+                  after.bytes - before.bytes};
+}
+
+} // namespace alloctest
+
+#endif // ALLOCCOUNTER_HPP
@@ -0,0 +1,326 @@
+// eitan.derdiger@gmail.com
+
+// Built as its own executable (see the Makefile): replacing the global operator new
+// affects every allocation of the binary it is linked into.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "AllocCounter.hpp"
+#include "MyContainer.hpp"
+#include "VersionedContainer.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+/*
+  Purpose:
+    - Install counting replacements for all forms of the global operator new / delete.
+    - Hold each API to an allocation budget, so a change that reintroduces allocations
+      on a hot path fails `make test`:
+        * end iterators of all six orders allocate nothing (and never sort);
+        * warm traversals of every order allocate nothing (sequences come from the
+          scratch arena), also with dead slots, and a cached AscendingOrder walk
+          allocates nothing at all;
+        * queries, reductions, and add()/remove() on an unshared reserved buffer
+          allocate nothing; add() with a snapshot outstanding copies the buffer once,
+          while held end iterators (or ones walked to the end) pin nothing;
+        * VersionedContainer::snapshot() allocates nothing (versions are prebuilt);
+        * a pmr container over a fixed arena sorts and merges its runs without the
+          global heap, and parallel_reduce takes its partial results from the container's
+          allocator (only the pool's job bookkeeping uses the global heap).
+    - test_small_buffer.cpp (same executable) covers the inline sequences of small
+      containers.
+*/
+
+namespace alloctest {
+
+Counts& counts() noexcept {
+    thread_local Counts local;
+    return local;
+}
+
+} // namespace alloctest
+
+namespace {
+
+void* countedAlloc(std::size_t size) {
+    alloctest::Counts& c = alloctest::counts();
+    ++c.allocations;
+    c.bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    alloctest::Counts& c = alloctest::counts();
+    ++c.allocations;
+    c.bytes += size;
+    std::size_t a = static_cast<std::size_t>(align);
+    return std::aligned_alloc(a, (size + a - 1) / a * a);  // Size must be a multiple of a
+}
+
+void countedFree(void* p) noexcept {
+    if (p) {
+        ++alloctest::counts().deallocations;
+        std::free(p);
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(size, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(size, align)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+
+using namespace container;
+
+namespace {
+
+constexpr int Large = 1000;  // Well past IndexSequence::InlineCapacity
+
+MyContainer<int> makeLarge() {
+    MyContainer<int> c;
+    c.reserve(Large);
+    for (int i = 0; i < Large; ++i) {
+        c.add((i * 7919) % Large);
+    }
+    return c;
+}
+
+// Walks [begin, end) with end() re-evaluated each step, as a typical loop does.
+template<typename Begin, typename End>
+long walk(Begin begin, End end) {
+    long sum = 0;
+    for (auto it = begin(); it != end(); ++it) {
+        sum += *it;
+    }
+    return sum;
+}
+
+} // namespace
+
+// Test that end iterators neither allocate nor build the sorted permutation
+TEST_CASE("End iterators allocate nothing") {
+    MyContainer<int> c = makeLarge();
+    alloctest::Counts used = alloctest::during([&] {
+        c.endOrder();
+        c.endAscendingOrder();
+        c.endDescendingOrder();
+        c.endReverseOrder();
+        c.endSideCrossOrder();
+        c.endMiddleOutOrder();
+        c.end();
+    });
+    CHECK(used.allocations == 0);
+
+    // No permutation was cached by the calls above: the first sorted walk builds it
+    CHECK(alloctest::during([&] { c.beginAscendingOrder(); }).allocations > 0);
+}
+
+// Test that warm traversals of every order stay off the global allocator
+TEST_CASE("Warm traversals allocate nothing") {
+    MyContainer<int> c = makeLarge();
+    long expected = walk([&] { return c.begin(); }, [&] { return c.end(); });
+    auto everyOrder = [&] {
+        CHECK(walk([&] { return c.begin(); }, [&] { return c.end(); }) == expected);
+        CHECK(walk([&] { return c.beginOrder(); }, [&] { return c.endOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginAscendingOrder(); }, [&] { return c.endAscendingOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginDescendingOrder(); }, [&] { return c.endDescendingOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginReverseOrder(); }, [&] { return c.endReverseOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginSideCrossOrder(); }, [&] { return c.endSideCrossOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginMiddleOutOrder(); }, [&] { return c.endMiddleOutOrder(); }) == expected);
+    };
+    everyOrder();  // Warms the permutation cache and the scratch arena
+    CHECK(alloctest::during(everyOrder).allocations == 0);
+}
+
+// Test that index-only orders skip dead slots without a temporary slot list
+TEST_CASE("Warm traversals with dead slots allocate nothing") {
+    MyContainer<int> c = makeLarge();
+    c.deferRemoval(true, 0.9);
+    c.remove(3);
+    c.remove(500);
+    REQUIRE(c.deadSlots() == 2);
+    long expected = walk([&] { return c.begin(); }, [&] { return c.end(); });
+    auto indexOnly = [&] {
+        CHECK(walk([&] { return c.beginOrder(); }, [&] { return c.endOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginReverseOrder(); }, [&] { return c.endReverseOrder(); }) == expected);
+        CHECK(walk([&] { return c.beginMiddleOutOrder(); }, [&] { return c.endMiddleOutOrder(); }) == expected);
+    };
+    indexOnly();
+    CHECK(alloctest::during(indexOnly).allocations == 0);
+}
+
+// Test that a cached ascending walk allocates nothing, not even from the scratch arena
+TEST_CASE("Cached AscendingOrder traversal allocates nothing") {
+    MyContainer<int> c = makeLarge();
+    long first = 0;
+    CHECK(alloctest::during([&] {
+        first = walk([&] { return c.beginAscendingOrder(); }, [&] { return c.endAscendingOrder(); });
+    }).allocations > 0);  // Builds the permutation
+
+    ScratchArena::Stats before = ScratchArena::stats();
+    long again = 0;
+    CHECK(alloctest::during([&] {
+        again = walk([&] { return c.beginAscendingOrder(); }, [&] { return c.endAscendingOrder(); });
+    }).allocations == 0);
+    ScratchArena::Stats after = ScratchArena::stats();
+    CHECK(after.allocations + after.reuses == before.allocations + before.reuses);
+    CHECK(again == first);
+}
+
+// Test that queries and reductions allocate nothing
+TEST_CASE("Queries and reductions allocate nothing") {
+    const MyContainer<int> c = makeLarge();
+    long checksum = 0;
+    alloctest::Counts used = alloctest::during([&] {
+        checksum += static_cast<long>(c.size());
+        checksum += static_cast<long>(c.count(7));
+        checksum += c.contains(Large + 1) ? 1 : 0;
+        checksum += c.min() + c.max();
+        checksum += static_cast<long>(c.sum());
+        checksum += static_cast<long>(c.mean());
+    });
+    CHECK(used.allocations == 0);
+    CHECK(checksum > 0);
+}
+
+// Test add()/remove() budgets on an unshared buffer and with a snapshot outstanding
+TEST_CASE("add() and remove() allocation budgets") {
+    MyContainer<int> c;
+    c.reserve(2 * Large);
+    c.add(0);
+    CHECK(alloctest::during([&] {
+        for (int i = 1; i < 2 * Large; ++i) {
+            c.add(i);
+        }
+    }).allocations == 0);
+    CHECK(alloctest::during([&] { c.remove(5); }).allocations == 0);
+
+    // A pinned snapshot makes the next add() copy the buffer: the shared block, the
+    // copied elements, and their growth for the new element (the copy is exact-fit)
+    auto pinned = c.snapshot();
+    CHECK(alloctest::during([&] { c.add(-5); }).allocations <= 3);
+    CHECK(alloctest::during([&] { c.add(-6); }).allocations == 0);  // Unshared again
+    CHECK(pinned->size() + 2 == c.size());
+}
+
+// Test that end iterators, and iterators walked to the end, never force a buffer copy
+TEST_CASE("Held end iterators do not pin the buffer") {
+    MyContainer<int> c;
+    c.reserve(2 * Large);
+    for (int i = 0; i < Large; ++i) {
+        c.add(i);
+    }
+    auto end = c.end();
+    auto endAscending = c.endAscendingOrder();
+    auto endMiddleOut = c.endMiddleOutOrder();
+    CHECK(c.snapshot().use_count() == 2);  // The container and this call only
+    CHECK(alloctest::during([&] { c.add(Large); }).allocations == 0);
+
+    auto it = c.begin();
+    long sum = 0;
+    for (auto e = c.end(); it != e; ++it) {
+        sum += *it;
+    }
+    CHECK(sum == long(Large) * (Large + 1) / 2);
+    CHECK(alloctest::during([&] { c.add(Large + 1); }).allocations == 0);
+    CHECK(c.size() == static_cast<size_t>(Large + 2));
+}
+
+// Test that sorting, merging and walking a pmr container stays inside its arena
+TEST_CASE("pmr container sorts and merges runs without the global heap") {
+    alignas(std::max_align_t) static std::byte arena[1 << 20];
+    std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena), std::pmr::null_memory_resource());
+    pmr::MyContainer<int> c(&pool);
+    std::vector<int> run;
+    for (int i = 0; i < Large; ++i) {
+        run.push_back(2 * i);
+    }
+    c.addSortedRun(run);
+    c.addSortedRun(run);
+    for (int i = 0; i < Large; ++i) {
+        c.add((i * 7919) % Large);  // Unsorted tail, sorted before the merge
+    }
+
+    long ascending = 0;
+    long descending = 0;
+    CHECK(alloctest::during([&] {
+        ascending = walk([&] { return c.beginAscendingOrder(); }, [&] { return c.endAscendingOrder(); });
+        descending = walk([&] { return c.beginDescendingOrder(); }, [&] { return c.endDescendingOrder(); });
+    }).allocations == 0);
+    CHECK(ascending == descending);
+    CHECK(*c.beginAscendingOrder() == 0);
+}
+
+// Test that parallel_reduce draws its partial results from the container's allocator
+TEST_CASE("parallel_reduce partials come from the container's allocator") {
+    struct Counting : std::pmr::memory_resource {
+        size_t allocations = 0;
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    } counting;
+    pmr::MyContainer<int> c(&counting);
+    for (int i = 0; i < Large; ++i) {
+        c.add(i);
+    }
+    auto from = c.beginOrder();
+    size_t before = counting.allocations;
+    long sum = c.parallel_reduce(from, 0L, [](long acc, int v) { return acc + v; },
+                                 [](long a, long b) { return a + b; }, 64);
+    CHECK(sum == long(Large) * (Large - 1) / 2);
+    CHECK(counting.allocations == before + 1);
+}
+
+// Test that acquiring a VersionedContainer snapshot allocates nothing
+TEST_CASE("VersionedContainer snapshot() allocates nothing") {
+    VersionedContainer<int> vc;
+    for (int i = 0; i < Large; ++i) {
+        vc.add(i);
+    }
+    VersionedContainer<int>::Version held;
+    size_t n = 0;
+    CHECK(alloctest::during([&] {
+        held = vc.snapshot();
+        n = vc.size();
+    }).allocations == 0);
+    CHECK(held->size() == n);
+}
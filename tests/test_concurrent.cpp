@@ -0,0 +1,114 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify that ConcurrentMyContainer<T> accepts add() from many threads at once.
+    - Confirm that merge() keeps every element and each producer's append order.
+    - Check that an element whose copy constructor throws is neither kept nor destroyed.
+*/
+
+#include "doctest.h"
+#include "ConcurrentMyContainer.hpp"
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace container;
+
+// Test multi-producer ingestion followed by a merged AscendingOrder view
+TEST_CASE("ConcurrentMyContainer merges concurrent producers") {
+    constexpr int producers = 8;
+    constexpr int perProducer = 1000;
+    ConcurrentMyContainer<int> cc(4);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < producers; ++t) {
+        threads.emplace_back([&cc, t] {
+            for (int k = 0; k < perProducer; ++k) {
+                cc.add(t * perProducer + k);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    CHECK(cc.size() == static_cast<size_t>(producers * perProducer));
+
+    MyContainer<int> merged = cc.merge();
+    CHECK(merged.size() == static_cast<size_t>(producers * perProducer));
+
+    // Ascending view covers every value exactly once
+    int expected = 0;
+    bool ascendingOk = true;
+    for (auto it = merged.beginAscendingOrder(); it != merged.endAscendingOrder(); ++it) {
+        ascendingOk = ascendingOk && (*it == expected++);
+    }
+    CHECK(ascendingOk);
+
+    // Insertion order preserves each producer's own append order
+    std::vector<int> last(producers, -1);
+    bool perThreadOrderOk = true;
+    for (int x : merged) {
+        int t = x / perProducer;
+        perThreadOrderOk = perThreadOrderOk && (x > last[t]);
+        last[t] = x;
+    }
+    CHECK(perThreadOrderOk);
+}
+
+// Test that non-trivial element types are constructed and destroyed correctly
+TEST_CASE("ConcurrentMyContainer stores non-trivial types across segments") {
+    ConcurrentMyContainer<std::string> cc(1);
+    for (int i = 0; i < 100; ++i) {
+        cc.add("item" + std::to_string(i));
+    }
+    MyContainer<std::string> merged = cc.merge();
+    CHECK(merged.size() == 100);
+    CHECK(*merged.beginOrder() == "item0");
+    CHECK(*merged.beginDescendingOrder() == "item99");
+}
+
+namespace {
+
+// Counts live instances; copying a negative value throws.
+struct Fragile {
+    static inline int live = 0;
+    int v;
+
+    explicit Fragile(int value) : v(value) { ++live; }
+    Fragile(const Fragile& other) : v(other.v) {
+        if (v < 0) throw std::runtime_error("copy failed");
+        ++live;
+    }
+    Fragile& operator=(const Fragile&) = default;
+    ~Fragile() { --live; }
+
+    bool operator<(const Fragile& other) const { return v < other.v; }
+    bool operator==(const Fragile& other) const { return v == other.v; }
+};
+
+} // namespace
+
+// Test that a throwing copy leaves a hole that merge(), size() and the destructor skip
+TEST_CASE("ConcurrentMyContainer survives a throwing copy constructor") {
+    {
+        ConcurrentMyContainer<Fragile> cc(1);
+        for (int i = 0; i < 40; ++i) {  // Spans the first two segments
+            if (i % 7 == 3) {
+                CHECK_THROWS_AS(cc.add(Fragile(-i)), std::runtime_error);
+            } else {
+                cc.add(Fragile(i));
+            }
+        }
+        CHECK(cc.size() == 34);
+        MyContainer<Fragile> merged = cc.merge();
+        CHECK(merged.size() == 34);
+        bool noHoles = true;
+        for (const Fragile& f : merged) {
+            noHoles = noHoles && f.v >= 0 && f.v % 7 != 3;
+        }
+        CHECK(noHoles);
+    }
+    CHECK(Fragile::live == 0);  // Every constructed element destroyed exactly once
+}
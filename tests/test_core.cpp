@@ -51,3 +51,17 @@ TEST_CASE("remove() does not modify size on failed removal") {
     CHECK_THROWS_AS(c.remove(123), std::runtime_error);
     CHECK(c.size() == 2);
 }
+
+// Test that a regular build carries no counters (see tests/test_stats.cpp)
+TEST_CASE("stats() is empty without MYCONTAINER_STATS") {
+    MyContainer<int> c;
+    c.add(2);
+    c.add(1);
+    c.beginAscendingOrder();
+    c.remove(2);
+    ContainerStats s = c.stats();
+    CHECK_FALSE(s.enabled);
+    CHECK(s.permutationBuilds == 0);
+    CHECK(s.removes == 0);
+    CHECK(s.toJson().find("\"enabled\": false") != std::string::npos);
+}
@@ -0,0 +1,111 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify ExternalContainer: insertion order and both sorted orders match an in-memory
+      sort, with a budget small enough to force many runs and several merge passes.
+    - Verify that iterators keep reading what existed when they were created, and that
+      invalid budgets and iterator misuse throw.
+*/
+
+#include "doctest.h"
+#include "ExternalContainer.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+template<typename Iterator>
+auto collect(Iterator it, Iterator end) {
+    std::vector<std::decay_t<decltype(*it)>> out;
+    for (; it != end; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+} // namespace
+
+// Test that a small budget spills runs, merges them in passes and still sorts correctly
+TEST_CASE("ExternalContainer sorts beyond its memory budget") {
+    ExternalContainer<int> c(16 << 10);  // 4096 ints per run, fan-in 3
+    CHECK(c.fanIn() == 3);
+    std::vector<int> values;
+    for (int i = 0; i < 100000; ++i) {
+        values.push_back(static_cast<int>((i * 2654435761u) % 50000) - 25000);  // With duplicates
+        c.add(values.back());
+    }
+    CHECK(c.size() == values.size());
+    CHECK(c.runCount() == 100000 / 4096);
+
+    CHECK(collect(c.beginOrder(), c.endOrder()) == values);
+
+    std::vector<int> ascending = values;
+    std::sort(ascending.begin(), ascending.end());
+    CHECK(collect(c.beginAscendingOrder(), c.endAscendingOrder()) == ascending);
+    CHECK(c.runCount() <= c.fanIn());
+
+    std::vector<int> descending = values;
+    std::sort(descending.begin(), descending.end(), std::greater<int>());
+    CHECK(collect(c.beginDescendingOrder(), c.endDescendingOrder()) == descending);
+
+    // Elements added after a merge join the next traversal as a new run
+    c.add(-30000);
+    c.add(30000);
+    std::vector<int> after = collect(c.beginAscendingOrder(), c.endAscendingOrder());
+    REQUIRE(after.size() == values.size() + 2);
+    CHECK(after.front() == -30000);
+    CHECK(after.back() == 30000);
+    CHECK(std::is_sorted(after.begin(), after.end()));
+}
+
+// Test empty containers and a single partial run
+TEST_CASE("ExternalContainer with few elements") {
+    ExternalContainer<double> c(64 << 10);
+    CHECK(c.beginAscendingOrder() == c.endAscendingOrder());
+    CHECK(c.beginOrder() == c.endOrder());
+
+    c.add(2.5);
+    c.add(-1.0);
+    c.add(7.25);
+    CHECK(collect(c.beginOrder(), c.endOrder()) == std::vector<double>{2.5, -1.0, 7.25});
+    CHECK(collect(c.beginAscendingOrder(), c.endAscendingOrder()) == std::vector<double>{-1.0, 2.5, 7.25});
+    CHECK(collect(c.beginDescendingOrder(), c.endDescendingOrder()) == std::vector<double>{7.25, 2.5, -1.0});
+    CHECK(c.runCount() == 1);
+}
+
+// Test that an iterator reads the elements present at its creation
+TEST_CASE("ExternalContainer iterators ignore later additions") {
+    ExternalContainer<long> c(16 << 10);
+    for (long i = 0; i < 20000; ++i) {
+        c.add(20000 - i);
+    }
+    auto it = c.beginAscendingOrder();
+    for (long i = 0; i < 50000; ++i) {
+        c.add(-i);  // Spills new runs; the next traversal runs merge passes again
+    }
+    std::vector<long> first = collect(it, c.endAscendingOrder());
+    REQUIRE(first.size() == 20000);
+    CHECK(first.front() == 1);
+    CHECK(first.back() == 20000);
+    CHECK(collect(c.beginAscendingOrder(), c.endAscendingOrder()).size() == 70000);
+}
+
+// Test invalid budgets and iterator misuse
+TEST_CASE("ExternalContainer errors") {
+    CHECK_THROWS_AS(ExternalContainer<int>(1024), std::runtime_error);
+    CHECK_THROWS_AS(ExternalContainer<int>(64 << 10, "/nonexistent-directory"), std::runtime_error);
+
+    ExternalContainer<int> c(64 << 10);
+    c.add(1);
+    auto it = c.beginAscendingOrder();
+    CHECK(*it == 1);
+    ++it;
+    CHECK(it == c.endAscendingOrder());
+    CHECK_THROWS_AS(*it, std::runtime_error);
+    CHECK_THROWS_AS(++it, std::runtime_error);
+}
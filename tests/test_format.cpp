@@ -0,0 +1,119 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify that the bulk formatter behind operator<< and io::print() produces exactly
+      what per-element stream insertion does, for every stream state it takes over and
+      the ones it hands back to operator<<, across block boundaries.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+// The output of the original operator<<: one insertion per element and separator.
+template<typename Iterator>
+std::string reference(const std::ostringstream& format, Iterator first, Iterator last) {
+    std::ostringstream os;
+    os.copyfmt(format);
+    os << "[";
+    bool separate = false;
+    for (; first != last; ++first) {
+        if (separate) os << ", ";
+        os << *first;
+        separate = true;
+    }
+    os << "]";
+    return os.str();
+}
+
+template<typename C>
+std::string printed(const std::ostringstream& format, const C& c) {
+    std::ostringstream os;
+    os.copyfmt(format);
+    os << c;
+    return os.str();
+}
+
+} // namespace
+
+// Test integers and doubles under the stream states the formatter handles itself
+TEST_CASE("Bulk formatting matches stream insertion") {
+    MyContainer<long long> ints;
+    MyContainer<double> doubles;
+    for (int i = 0; i < 30000; ++i) {  // Several 64 KiB blocks
+        ints.add((i % 2 ? -1LL : 1LL) * i * 7919);
+        doubles.add((i - 15000) / 7.0 + 1e-9 * i);
+    }
+    doubles.add(1e300);
+    doubles.add(-0.0);
+
+    std::ostringstream plain, precise, fixed, scientific;
+    precise << std::setprecision(17);
+    fixed << std::fixed << std::setprecision(3);
+    scientific << std::scientific;
+
+    CHECK(printed(plain, ints) == reference(plain, ints.beginOrder(), ints.endOrder()));
+    for (const std::ostringstream* format : {&plain, &precise, &fixed, &scientific}) {
+        CHECK(printed(*format, doubles) == reference(*format, doubles.beginOrder(), doubles.endOrder()));
+    }
+}
+
+// Test that other stream states and element types keep the stream path
+TEST_CASE("Bulk formatting falls back to operator<<") {
+    MyContainer<int> ints;
+    for (int v : {255, -3, 0, 16}) {
+        ints.add(v);
+    }
+    std::ostringstream hex, showpos, wide;
+    hex << std::hex << std::showbase;
+    showpos << std::showpos;
+    wide << std::setw(6);
+    for (const std::ostringstream* format : {&hex, &showpos}) {
+        CHECK(printed(*format, ints) == reference(*format, ints.beginOrder(), ints.endOrder()));
+    }
+    CHECK(printed(wide, ints) == "     [255, -3, 0, 16]");
+
+    MyContainer<char> chars;
+    chars.add('b');
+    chars.add('a');
+    std::ostringstream plain;
+    CHECK(printed(plain, chars) == "[b, a]");
+
+    MyContainer<std::string> words;
+    words.add("pear");
+    words.add("fig");
+    CHECK(printed(plain, words) == "[pear, fig]");
+}
+
+// Test io::print over other orders and operator<< with dead slots
+TEST_CASE("io::print writes any traversal order") {
+    MyContainer<int> c;
+    for (int v : {7, 15, 6, 1, 2}) {
+        c.add(v);
+    }
+    std::ostringstream os;
+    io::print(os, c.beginSideCrossOrder(), c.endSideCrossOrder());
+    CHECK(os.str() == "[1, 15, 2, 7, 6]");
+    os.str("");
+    io::print(os, c.beginReverseOrder(), c.endReverseOrder());
+    CHECK(os.str() == "[2, 1, 6, 15, 7]");
+
+    c.deferRemoval(true, 1.0);
+    c.remove(6);
+    os.str("");
+    os << c;
+    CHECK(os.str() == "[7, 15, 1, 2]");
+
+    MyContainer<int> empty;
+    os.str("");
+    os << empty;
+    CHECK(os.str() == "[]");
+}
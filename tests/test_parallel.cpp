@@ -0,0 +1,116 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify MyContainer<T>::parallel_for_each and parallel_reduce over the traversal orders.
+    - Confirm that the reduction combines chunk results in traversal order.
+    - Confirm that run() issued from inside a body (e.g. a lazily merged sorted
+      permutation) runs inline instead of deadlocking.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+// Test that parallel_for_each visits every element exactly once
+TEST_CASE("parallel_for_each visits every element of an order") {
+    MyContainer<int> c;
+    for (int i = 0; i < 10000; ++i) {
+        c.add((i * 7919) % 10000);
+    }
+
+    std::vector<std::atomic<int>> hits(10000);
+    c.parallel_for_each(c.beginSideCrossOrder(), [&](int x) { hits[x].fetch_add(1); }, 64);
+    bool allOnce = true;
+    for (auto& h : hits) {
+        allOnce = allOnce && h.load() == 1;
+    }
+    CHECK(allOnce);
+
+    // Starting mid-way only covers the rest of the traversal
+    auto it = c.beginAscendingOrder();
+    for (int i = 0; i < 9990; ++i) ++it;
+    std::atomic<long> sum{0};
+    c.parallel_for_each(it, [&](int x) { sum.fetch_add(x); });
+    CHECK(sum.load() == 9990 + 9991 + 9992 + 9993 + 9994 + 9995 + 9996 + 9997 + 9998 + 9999);
+
+    MyContainer<int> other;
+    CHECK_THROWS_AS(other.parallel_for_each(c.beginOrder(), [](int) {}), std::runtime_error);
+}
+
+// Test that parallel_reduce preserves traversal order for non-commutative combine
+TEST_CASE("parallel_reduce combines chunks in traversal order") {
+    MyContainer<std::string> c;
+    const std::string letters = "qwertyuiopasdfghjklzxcvbnm";
+    for (char ch : letters) {
+        c.add(std::string(1, ch));
+    }
+
+    auto concat = [](std::string acc, const std::string& s) { return acc + s; };
+    auto join = [](std::string a, std::string b) { return a + b; };
+    CHECK(c.parallel_reduce(c.beginAscendingOrder(), std::string(), concat, join, 3)
+          == "abcdefghijklmnopqrstuvwxyz");
+    CHECK(c.parallel_reduce(c.beginReverseOrder(), std::string(), concat, join, 5)
+          == std::string(letters.rbegin(), letters.rend()));
+
+    // Exceptions from fn propagate to the caller
+    CHECK_THROWS_AS(c.parallel_for_each(c.beginOrder(),
+                                        [](const std::string&) { throw std::runtime_error("x"); }, 2),
+                    std::runtime_error);
+}
+
+// Test the pool itself with several workers, independent of the machine's core count
+TEST_CASE("WorkStealingPool runs every chunk once with multiple workers") {
+    parallel::WorkStealingPool pool(3);
+    CHECK(pool.participants() == 4);
+    for (int round = 0; round < 20; ++round) {
+        std::vector<std::atomic<int>> hits(257);
+        pool.run(hits.size(), [&](size_t chunk) { hits[chunk].fetch_add(1); });
+        bool allOnce = true;
+        for (auto& h : hits) {
+            allOnce = allOnce && h.load() == 1;
+        }
+        CHECK(allOnce);
+    }
+}
+
+// Test that a nested run() executes inline on the calling participant
+TEST_CASE("WorkStealingPool runs nested calls inline") {
+    parallel::WorkStealingPool pool(3);
+    std::atomic<int> inner{0};
+    CHECK_FALSE(pool.inBody());
+    pool.run(8, [&](size_t) {
+        CHECK(pool.inBody());
+        pool.run(16, [&](size_t) { inner.fetch_add(1); });
+    });
+    CHECK(inner.load() == 8 * 16);
+    CHECK_FALSE(pool.inBody());
+}
+
+// Test that a sorted order first built inside a parallel body (a merge of large sorted
+// runs, which uses the shared pool itself) completes
+TEST_CASE("Sorted permutation built inside parallel_for_each does not deadlock") {
+    MyContainer<int> runs;
+    std::vector<int> evens, odds;
+    for (int i = 0; i < 40000; ++i) {
+        evens.push_back(2 * i);
+        odds.push_back(2 * i + 1);
+    }
+    runs.addSortedRun(evens);
+    runs.addSortedRun(odds);
+
+    MyContainer<int> outer;
+    for (int i = 0; i < 4; ++i) {
+        outer.add(i);
+    }
+    std::atomic<int> smallest{-1};
+    outer.parallel_for_each(outer.beginOrder(), [&](int) {
+        smallest.store(*runs.beginAscendingOrder());
+    }, 1);
+    CHECK(smallest.load() == 0);
+    CHECK(*runs.beginDescendingOrder() == 79999);
+}
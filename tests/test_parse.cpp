@@ -0,0 +1,121 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify MyContainer<T>::parse(): it reads operator<< output back exactly, accepts
+      newline- and whitespace-separated numbers, handles numbers split across stream
+      chunks, and rejects malformed or out-of-range tokens.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+template<typename Iterator>
+auto collect(Iterator it, Iterator end) {
+    std::vector<std::decay_t<decltype(*it)>> out;
+    for (; it != end; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+} // namespace
+
+// Test that parse() inverts operator<<
+TEST_CASE("parse() reads operator<< output back") {
+    MyContainer<int> ints;
+    for (int v : {5, -17, 0, 2147483647, -2147483647 - 1}) {
+        ints.add(v);
+    }
+    std::ostringstream os;
+    os << ints;
+    MyContainer<int> back = MyContainer<int>::parse(os.str());
+    CHECK(collect(back.beginOrder(), back.endOrder()) == collect(ints.beginOrder(), ints.endOrder()));
+
+    MyContainer<double> doubles;
+    for (double v : {0.1, -2.5e-300, 1.0 / 3.0, 123456789.125}) {
+        doubles.add(v);
+    }
+    std::ostringstream exact;
+    exact << std::setprecision(17) << doubles;
+    MyContainer<double> doublesBack = MyContainer<double>::parse(exact.str());
+    CHECK(collect(doublesBack.beginOrder(), doublesBack.endOrder()) ==
+          collect(doubles.beginOrder(), doubles.endOrder()));
+
+    CHECK(MyContainer<int>::parse("[]").size() == 0);
+    CHECK(MyContainer<int>::parse("").size() == 0);
+}
+
+// Test other layouts: one number per line, CRLF, tabs, leading '+'
+TEST_CASE("parse() accepts whitespace and newline separated numbers") {
+    MyContainer<long> c = MyContainer<long>::parse("3\n+4\r\n-5\t6  7,8\n");
+    CHECK(collect(c.beginOrder(), c.endOrder()) == std::vector<long>{3, 4, -5, 6, 7, 8});
+    CHECK(*c.beginAscendingOrder() == -5);
+
+    // Spaces and tabs alone still give one exact reservation
+    std::vector<int> spaced;
+    io::parseInto<int>(spaced, "1 2\t3  4 \t 5 [6] 7");
+    CHECK(spaced == std::vector<int>{1, 2, 3, 4, 5, 6, 7});
+    CHECK(spaced.capacity() == spaced.size());
+
+    std::istringstream in("1 2\n3");
+    MyContainer<float> f = MyContainer<float>::parse(in);
+    CHECK(f.size() == 3);
+    CHECK(f.sum() == doctest::Approx(6.0));
+}
+
+// Test that numbers cut by the 1 MiB chunk border are joined again
+TEST_CASE("parse() from a stream across chunk borders") {
+    std::string text;
+    std::vector<long long> expected;
+    for (long long i = 0; i < 200000; ++i) {  // About 2.5 MB of text
+        long long v = (i * 2654435761LL) % 100000000000LL - 50000000000LL;
+        expected.push_back(v);
+        text += std::to_string(v);
+        text += (i % 7 == 0) ? "\n" : ", ";
+    }
+    std::istringstream in(text);
+    MyContainer<long long> fromStream = MyContainer<long long>::parse(in);
+    CHECK(collect(fromStream.beginOrder(), fromStream.endOrder()) == expected);
+    MyContainer<long long> fromText = MyContainer<long long>::parse(text);
+    CHECK(fromText.size() == expected.size());
+    CHECK(fromText.sum() == fromStream.sum());
+
+    // A sign or exponent on the last byte of a chunk is not a complete token yet
+    const size_t chunk = size_t(1) << 20;
+    std::istringstream sign(std::string(chunk - 1, ' ') + "-5");
+    CHECK(MyContainer<int>::parse(sign).sum() == -5);
+    std::istringstream exponent(std::string(chunk - 4, ' ') + "1.5e3");
+    CHECK(MyContainer<double>::parse(exponent).sum() == doctest::Approx(1500.0));
+}
+
+// Test malformed input
+TEST_CASE("parse() rejects invalid tokens") {
+    CHECK_THROWS_AS(MyContainer<int>::parse("1, x, 3"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<int>::parse("1.5"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<int>::parse("99999999999"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<unsigned>::parse("-1"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<double>::parse("1e"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<int>::parse("+"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<int>::parse("+-5"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<double>::parse("1, +-2.5"), std::runtime_error);
+    CHECK_THROWS_AS(MyContainer<int>::parse("++5"), std::runtime_error);
+    std::istringstream signs("+-5\n");
+    CHECK_THROWS_AS(MyContainer<int>::parse(signs), std::runtime_error);
+    try {
+        MyContainer<int>::parse("10, 20, 3O");
+        FAIL("expected an exception");
+    } catch (const std::runtime_error& e) {
+        CHECK(std::string(e.what()) == "Invalid number at offset 8");
+    }
+    std::istringstream in("1\n2\nbad\n");
+    CHECK_THROWS_AS(MyContainer<int>::parse(in), std::runtime_error);
+}
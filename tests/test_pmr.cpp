@@ -0,0 +1,158 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify that container::pmr::MyContainer<T> draws its element buffer, cached
+      permutation and iterator sequences from the given std::pmr::memory_resource.
+    - Verify allocator propagation on copy construction and assignment, and that a copy
+      into another resource never reads the source's memory.
+    - Verify the parallel merge of sorted runs with arena-allocated scratch.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+// Forwards to an upstream resource and counts the allocations it serves.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+// Test that a monotonic arena with no upstream serves every buffer
+TEST_CASE("pmr container runs entirely inside a monotonic arena") {
+    static std::byte arena[1 << 16];
+    std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena), std::pmr::null_memory_resource());
+
+    pmr::MyContainer<int> c(&pool);
+    for (int i = 0; i < 500; ++i) {
+        c.add((i * 37) % 101);
+    }
+    c.remove(0);
+
+    int previous = -1;
+    size_t seen = 0;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        CHECK(previous <= *it);
+        previous = *it;
+        ++seen;
+    }
+    CHECK(seen == c.size());
+    CHECK(*c.beginDescendingOrder() == 100);
+    CHECK(*c.beginSideCrossOrder() == 1);
+    CHECK(*c.beginReverseOrder() == (499 * 37) % 101);
+    CHECK(c.get_allocator().resource() == &pool);
+}
+
+// Test that all buffer kinds go through the resource
+TEST_CASE("pmr container allocates elements and permutations from its resource") {
+    CountingResource counting;
+    pmr::MyContainer<double> c(&counting);
+    for (int i = 0; i < 64; ++i) {
+        c.add(64.0 - i);
+    }
+    size_t afterAdds = counting.allocations;
+    CHECK(afterAdds > 0);
+
+    CHECK(*c.beginAscendingOrder() == 1.0);  // Builds the cached permutation
+    CHECK(counting.allocations > afterAdds);
+
+    size_t afterSort = counting.allocations;
+    CHECK(*c.beginMiddleOutOrder() == 33.0);  // Heap-backed iterator sequence
+    CHECK(counting.allocations > afterSort);
+}
+
+// Test allocator propagation rules
+TEST_CASE("pmr container copies follow std allocator rules") {
+    CountingResource first;
+    CountingResource second;
+    pmr::MyContainer<int> a(&first);
+    a.add(3);
+    a.add(1);
+
+    pmr::MyContainer<int> copy(a);  // pmr copies default to the default resource
+    CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+    CHECK(copy.size() == 2);
+
+    pmr::MyContainer<int> b(&second);
+    b = a;  // Assignment keeps b's resource
+    CHECK(b.get_allocator().resource() == &second);
+    size_t before = second.allocations;
+    b.add(2);  // Detaches from a's buffer into b's resource
+    CHECK(second.allocations > before);
+    CHECK(a.size() == 2);
+    CHECK(*b.beginAscendingOrder() == 1);
+}
+
+// Test that copies into another resource survive the source's arena
+TEST_CASE("pmr copies do not read the source's arena") {
+    alignas(std::max_align_t) static std::byte arena[1 << 16];
+    pmr::MyContainer<int> assigned;
+    std::optional<pmr::MyContainer<int>> constructed;
+    {
+        std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena), std::pmr::null_memory_resource());
+        pmr::MyContainer<int> source(&pool);
+        for (int i = 0; i < 100; ++i) {
+            source.add((i * 37) % 101);
+        }
+        CHECK(*source.beginAscendingOrder() == 0);  // Caches the permutation in the arena
+        assigned = source;
+        constructed.emplace(source, std::pmr::polymorphic_allocator<int>());
+    }
+    std::fill(std::begin(arena), std::end(arena), std::byte{0xAB});  // Scribble over it
+
+    for (const pmr::MyContainer<int>* c : {&assigned, &*constructed}) {
+        REQUIRE(c->size() == 100);
+        int previous = -1;
+        for (auto it = c->beginAscendingOrder(); it != c->endAscendingOrder(); ++it) {
+            CHECK(previous < *it);
+            previous = *it;
+        }
+        CHECK(*c->beginOrder() == 0);
+        CHECK(*c->beginReverseOrder() == (99 * 37) % 101);
+    }
+}
+
+// Test that the parallel merge of sorted runs works with arena-allocated scratch
+TEST_CASE("pmr container merges large sorted runs") {
+    std::pmr::monotonic_buffer_resource pool;
+    pmr::MyContainer<int> c(&pool);
+    std::vector<int> evens;
+    std::vector<int> odds;
+    for (int i = 0; i < 40000; ++i) {
+        evens.push_back(2 * i);
+        odds.push_back(2 * i + 1);
+    }
+    c.addSortedRun(evens);
+    c.addSortedRun(odds);
+    int expected = 0;
+    size_t mismatches = 0;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        mismatches += *it != expected++;
+    }
+    CHECK(mismatches == 0);
+    CHECK(expected == 80000);
+}
@@ -0,0 +1,116 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify MyContainer<T>::min(), max(), minmax(), sum() and mean()
+      for vectorized and generic element types.
+    - Verify running min/max tracking across mutations and moves.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <cstdint>
+#include <string>
+
+using namespace container;
+
+// Test reductions on vectorized types, with lengths that leave a scalar tail
+TEST_CASE("Reductions on int, float and double containers") {
+    MyContainer<int> ci;
+    MyContainer<float> cf;
+    MyContainer<double> cd;
+    long long expectSum = 0;
+    for (int i = 0; i < 37; ++i) {
+        int v = (i * 29) % 41 - 20;
+        ci.add(v);
+        cf.add(static_cast<float>(v) * 0.5f);
+        cd.add(static_cast<double>(v) * 0.25);
+        expectSum += v;
+    }
+    ci.add(2000000000);
+    ci.add(2000000000);  // Sum exceeds INT_MAX without overflowing
+
+    CHECK(ci.min() == -20);
+    CHECK(ci.max() == 2000000000);
+    CHECK(ci.sum() == expectSum + 4000000000LL);
+    CHECK(cf.minmax() == std::pair<float, float>(-10.0f, 10.0f));
+    CHECK(cd.minmax() == std::pair<double, double>(-5.0, 5.0));
+    CHECK(cf.sum() == doctest::Approx(expectSum * 0.5));
+    CHECK(cd.mean() == doctest::Approx(expectSum * 0.25 / 37));
+}
+
+// Test generic fallbacks and empty containers
+TEST_CASE("Reductions on generic types and empty containers") {
+    MyContainer<std::string> s;
+    s.add("pear");
+    s.add("apple");
+    s.add("zucchini");
+    CHECK(s.min() == "apple");
+    CHECK(s.max() == "zucchini");
+
+    MyContainer<int64_t> big;
+    big.add(-5);
+    big.add(7);
+    CHECK(big.minmax() == std::pair<int64_t, int64_t>(-5, 7));
+    CHECK(big.sum() == 2);
+
+    MyContainer<int> empty;
+    CHECK_THROWS_AS(empty.min(), std::runtime_error);
+    CHECK_THROWS_AS(empty.mean(), std::runtime_error);
+    CHECK(empty.sum() == 0);
+}
+
+// Test that tracked extremes follow add(), addSortedRun() and remove()
+TEST_CASE("Tracked extrema stay correct across mutations") {
+    MyContainer<int> c;
+    c.add(5);
+    c.add(9);
+    c.trackExtrema(true);
+    CHECK(c.tracksExtrema());
+    CHECK(c.minmax() == std::pair<int, int>(5, 9));
+
+    c.add(2);
+    c.addSortedRun({3, 4, 12});
+    CHECK(c.min() == 2);
+    CHECK(c.max() == 12);
+
+    c.remove(4);   // Not an extreme: no rescan needed
+    CHECK(c.minmax() == std::pair<int, int>(2, 12));
+    c.remove(12);  // Current max removed: rescanned
+    CHECK(c.max() == 9);
+    c.remove(2);
+    CHECK(c.min() == 3);
+    CHECK(c.min() == *c.beginAscendingOrder());
+    CHECK(c.max() == *c.beginDescendingOrder());
+
+    c.remove(3);
+    c.remove(5);
+    c.remove(9);
+    CHECK_THROWS_AS(c.min(), std::runtime_error);
+    c.add(-1);
+    CHECK(c.minmax() == std::pair<int, int>(-1, -1));
+
+    c.trackExtrema(false);
+    c.add(-7);
+    CHECK(c.min() == -7);
+}
+
+// Test that a moved-from container forgets its tracked extremes
+TEST_CASE("Moved-from containers start with fresh extrema") {
+    MyContainer<int> c;
+    c.trackExtrema(true);
+    c.add(1);
+    c.add(100);
+
+    MyContainer<int> d(std::move(c));
+    CHECK(d.minmax() == std::pair<int, int>(1, 100));
+    c.add(50);
+    CHECK(c.min() == 50);
+    CHECK(c.max() == 50);
+
+    MyContainer<int> e;
+    e = std::move(d);
+    CHECK(e.minmax() == std::pair<int, int>(1, 100));
+    d.add(50);
+    CHECK(d.minmax() == std::pair<int, int>(50, 50));
+}
@@ -0,0 +1,102 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify that repeated iterator construction over a large container reuses the
+      per-thread ScratchArena blocks (zero allocations once warm).
+    - Verify size classes, the per-class and per-thread cache limits, trim() and the
+      ScratchAllocator interface.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+// Builds begin/end of all six orders and reads one element of each.
+int touchAllOrders(const MyContainer<int>& c) {
+    int sum = 0;
+    sum += *c.beginOrder() + (c.endOrder() == c.endOrder());
+    sum += *c.beginAscendingOrder() + (c.endAscendingOrder() == c.endAscendingOrder());
+    sum += *c.beginDescendingOrder() + (c.endDescendingOrder() == c.endDescendingOrder());
+    sum += *c.beginReverseOrder() + (c.endReverseOrder() == c.endReverseOrder());
+    sum += *c.beginSideCrossOrder() + (c.endSideCrossOrder() == c.endSideCrossOrder());
+    sum += *c.beginMiddleOutOrder() + (c.endMiddleOutOrder() == c.endMiddleOutOrder());
+    return sum;
+}
+
+} // namespace
+
+// Test steady-state iterator construction
+TEST_CASE("Repeated iterator construction reaches zero allocations") {
+    MyContainer<int> c;
+    for (int i = 0; i < 1000; ++i) {
+        c.add((i * 7919) % 1000);
+    }
+
+    int warm = touchAllOrders(c);
+    ScratchArena::Stats before = ScratchArena::stats();
+    for (int round = 0; round < 50; ++round) {
+        CHECK(touchAllOrders(c) == warm);
+    }
+    ScratchArena::Stats after = ScratchArena::stats();
+    CHECK(after.allocations == before.allocations);
+    CHECK(after.reuses > before.reuses);
+}
+
+// Test block reuse and the per-class cache limit
+TEST_CASE("ScratchArena reuses released blocks of the same size class") {
+    ScratchArena::Stats start = ScratchArena::stats();
+    void* a = ScratchArena::allocate(1000);
+    ScratchArena::release(a, 1000);
+    void* b = ScratchArena::allocate(1024);  // Same 1 KiB class
+    CHECK(b == a);
+    ScratchArena::release(b, 1024);
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < ScratchArena::MaxCachedPerClass + 3; ++i) {
+        blocks.push_back(ScratchArena::allocate(3000));
+    }
+    for (void* p : blocks) {
+        ScratchArena::release(p, 3000);
+    }
+    ScratchArena::Stats end = ScratchArena::stats();
+    CHECK(end.cached - start.cached <= ScratchArena::MaxCachedPerClass + 1);
+
+    ScratchAllocator<size_t> alloc;
+    std::vector<size_t, ScratchAllocator<size_t>> v(100, 7, alloc);
+    CHECK(v[99] == 7);
+    CHECK(alloc == ScratchAllocator<int>());
+}
+
+// Test the per-thread byte cap, oversized blocks and trim()
+TEST_CASE("ScratchArena caps its cache and trims on request") {
+    ScratchArena::trim();
+    CHECK(ScratchArena::stats().cached == 0);
+    CHECK(ScratchArena::stats().cachedBytes == 0);
+
+    // Blocks past the largest class are never cached
+    size_t huge = (size_t(1) << ScratchArena::MaxClassBits) + 1;
+    ScratchArena::release(ScratchArena::allocate(huge), huge);
+    CHECK(ScratchArena::stats().cached == 0);
+
+    // Largest-class blocks fill the byte cap before the per-class count limit
+    size_t big = size_t(1) << ScratchArena::MaxClassBits;
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < ScratchArena::MaxCachedPerClass; ++i) {
+        blocks.push_back(ScratchArena::allocate(big));
+    }
+    for (void* p : blocks) {
+        ScratchArena::release(p, big);
+    }
+    ScratchArena::Stats s = ScratchArena::stats();
+    CHECK(s.cachedBytes <= ScratchArena::MaxCachedBytes);
+    CHECK(s.cached == ScratchArena::MaxCachedBytes / big);
+
+    CHECK(ScratchArena::trim() == s.cachedBytes);
+    CHECK(ScratchArena::stats().cached == 0);
+    CHECK(ScratchArena::stats().cachedBytes == 0);
+}
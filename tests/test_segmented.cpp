@@ -0,0 +1,120 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify MyContainer with the SegmentedStorage policy: all six orders, remove(),
+      queries and reductions must match the contiguous default across chunk borders.
+    - Verify that growth keeps element addresses stable and that SegmentedVector
+      honours its allocator.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+using Segmented = MyContainer<int, std::allocator<int>, SegmentedStorage>;
+
+template<typename Iterator>
+std::vector<int> collect(Iterator it, Iterator end) {
+    std::vector<int> out;
+    for (; it != end; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+} // namespace
+
+// Test that every order matches the contiguous container across several chunks
+TEST_CASE("Segmented storage matches contiguous storage in all orders") {
+    Segmented seg;
+    MyContainer<int> vec;
+    size_t n = 3 * SegmentedVector<int>::ChunkSize + 123;
+    for (size_t i = 0; i < n; ++i) {
+        int v = static_cast<int>((i * 7919) % 5003) - 2500;
+        seg.add(v);
+        vec.add(v);
+    }
+    seg.remove(17);
+    vec.remove(17);
+
+    CHECK(seg.size() == vec.size());
+    CHECK(collect(seg.beginOrder(), seg.endOrder()) == collect(vec.beginOrder(), vec.endOrder()));
+    CHECK(collect(seg.beginAscendingOrder(), seg.endAscendingOrder()) ==
+          collect(vec.beginAscendingOrder(), vec.endAscendingOrder()));
+    CHECK(collect(seg.beginDescendingOrder(), seg.endDescendingOrder()) ==
+          collect(vec.beginDescendingOrder(), vec.endDescendingOrder()));
+    CHECK(collect(seg.beginReverseOrder(), seg.endReverseOrder()) ==
+          collect(vec.beginReverseOrder(), vec.endReverseOrder()));
+    CHECK(collect(seg.beginSideCrossOrder(), seg.endSideCrossOrder()) ==
+          collect(vec.beginSideCrossOrder(), vec.endSideCrossOrder()));
+    CHECK(collect(seg.beginMiddleOutOrder(), seg.endMiddleOutOrder()) ==
+          collect(vec.beginMiddleOutOrder(), vec.endMiddleOutOrder()));
+
+    CHECK(seg.count(-2500) == vec.count(-2500));
+    CHECK_FALSE(seg.contains(17));
+    CHECK(seg.minmax() == vec.minmax());
+    CHECK(seg.sum() == vec.sum());
+    long long viaPool = seg.parallel_reduce(seg.beginOrder(), 0LL,
+        [](long long acc, int v) { return acc + v; },
+        [](long long a, long long b) { return a + b; });
+    CHECK(viaPool == vec.sum());
+}
+
+// Test that growth never moves existing elements
+TEST_CASE("Segmented storage keeps element addresses stable") {
+    Segmented c;
+    c.add(42);
+    const int* first = &(*c.snapshot())[0];
+    for (int i = 0; i < 100000; ++i) {
+        c.add(i);
+    }
+    CHECK(&(*c.snapshot())[0] == first);
+    CHECK(*c.beginOrder() == 42);
+}
+
+// Test sorted runs, extrema tracking and non-arithmetic elements on chunks
+TEST_CASE("Segmented storage supports runs, tracking and strings") {
+    Segmented runs;
+    std::vector<int> a, b;
+    for (int i = 0; i < 5000; ++i) {
+        a.push_back(2 * i);
+        b.push_back(2 * i + 1);
+    }
+    runs.trackExtrema(true);
+    runs.addSortedRun(a);
+    runs.addSortedRun(b);
+    runs.remove(0);
+    CHECK(runs.min() == 1);
+    CHECK(runs.max() == 9999);
+    std::vector<int> ascending = collect(runs.beginAscendingOrder(), runs.endAscendingOrder());
+    CHECK(ascending.size() == 9999);
+    CHECK(std::is_sorted(ascending.begin(), ascending.end()));
+
+    MyContainer<std::string, std::allocator<std::string>, SegmentedStorage> words;
+    for (const char* w : {"pear", "apple", "fig"}) {
+        words.add(w);
+    }
+    words.remove("pear");
+    CHECK(*words.beginAscendingOrder() == "apple");
+    CHECK(words.size() == 2);
+}
+
+// Test that a pmr segmented container allocates its chunks from the resource
+TEST_CASE("Segmented storage with a memory resource") {
+    std::pmr::monotonic_buffer_resource pool;
+    pmr::MyContainer<int, SegmentedStorage> c(&pool);
+    for (int i = 0; i < 10000; ++i) {
+        c.add(10000 - i);
+    }
+    CHECK(c.snapshot()->get_allocator().resource() == &pool);
+    CHECK(*c.beginAscendingOrder() == 1);
+    CHECK(c.size() == 10000);
+}
@@ -0,0 +1,260 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify the binary format: lossless round trips for raw and string elements,
+      deferred-removal slots left out, and rejection of foreign or damaged files.
+    - Verify io::openMapped(): elements are read in place and copied on first mutation.
+*/
+
+#include "doctest.h"
+#include "io/Serialization.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+constexpr size_t HeaderBytes = 48;
+
+std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+template<typename Iterator>
+auto collect(Iterator it, Iterator end) {
+    std::vector<std::decay_t<decltype(*it)>> out;
+    for (; it != end; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+} // namespace
+
+// Test that doubles keep their exact bit patterns and strings keep every byte
+TEST_CASE("Binary round trip is lossless") {
+    std::string path = tempPath("mycontainer_roundtrip.bin");
+    MyContainer<double> doubles;
+    std::vector<double> values{0.1, -0.0, 1e-310, std::numeric_limits<double>::max(), 1.0 / 3.0};
+    for (double v : values) {
+        doubles.add(v);
+    }
+    io::save(doubles, path);
+    MyContainer<double> back = io::load<double>(path);
+    std::vector<double> read = collect(back.beginOrder(), back.endOrder());
+    REQUIRE(read.size() == values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK(std::memcmp(&read[i], &values[i], sizeof(double)) == 0);
+    }
+
+    MyContainer<std::string> words;
+    for (const char* w : {"plain", "", "with, comma", "line\nbreak"}) {
+        words.add(w);
+    }
+    words.add(std::string("nul\0inside", 10));
+    io::save(words, path);
+    MyContainer<std::string> wordsBack = io::load<std::string>(path);
+    CHECK(collect(wordsBack.beginOrder(), wordsBack.endOrder()) ==
+          collect(words.beginOrder(), words.endOrder()));
+    std::remove(path.c_str());
+}
+
+// Test that dead slots are not written and other storage policies can load
+TEST_CASE("Binary save skips dead slots and loads into any policy") {
+    std::string path = tempPath("mycontainer_policies.bin");
+    MyContainer<int> c;
+    c.deferRemoval(true, 1.0);
+    for (int i = 0; i < 10000; ++i) {
+        c.add(i % 100);
+    }
+    c.remove(42);
+    io::save(c, path);
+
+    auto seg = io::load<int, std::allocator<int>, SegmentedStorage>(path);
+    CHECK(seg.size() == 9900);
+    CHECK_FALSE(seg.contains(42));
+    CHECK(seg.sum() == c.sum());
+    std::remove(path.c_str());
+}
+
+// Test in-place reads, copy on first mutation and that the file stays untouched
+TEST_CASE("Mapped open reads in place and copies on mutation") {
+    std::string path = tempPath("mycontainer_mapped.bin");
+    MyContainer<int> c;
+    for (int i = 0; i < 5000; ++i) {
+        c.add(5000 - i);
+    }
+    io::save(c, path);
+
+    auto mapped = io::openMapped<int>(path);
+    CHECK(mapped.snapshot()->isMapped());
+    CHECK(mapped.size() == 5000);
+    CHECK(*mapped.beginAscendingOrder() == 1);
+    CHECK(*mapped.beginOrder() == 5000);
+    CHECK(mapped.sum() == c.sum());
+
+    auto pinned = mapped.beginOrder();
+    mapped.add(-7);
+    mapped.remove(5000);
+    CHECK_FALSE(mapped.snapshot()->isMapped());
+    CHECK(*mapped.beginAscendingOrder() == -7);
+    CHECK(*pinned == 5000);  // The iterator still reads the mapped version
+
+    auto reopened = io::openMapped<int>(path);
+    CHECK(reopened.size() == 5000);
+    CHECK(reopened.contains(5000));
+
+    // A damaged element is found by load() and verify; the default open does not read it
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        int damaged = -1;
+        f.seekp(HeaderBytes + 10 * sizeof(int));
+        f.write(reinterpret_cast<const char*>(&damaged), sizeof(damaged));
+    }
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::openMapped<int>(path, true), std::runtime_error);
+    CHECK(io::openMapped<int>(path).contains(-1));
+    std::remove(path.c_str());
+}
+
+// Test rejection of missing, foreign, mistyped and truncated files
+TEST_CASE("Binary load rejects invalid files") {
+    std::string path = tempPath("mycontainer_invalid.bin");
+    CHECK_THROWS_AS(io::load<int>(tempPath("mycontainer_missing.bin")), std::runtime_error);
+    CHECK_THROWS_AS(io::openMapped<int>(tempPath("mycontainer_missing.bin")), std::runtime_error);
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "[1, 2, 3] is text, not a container file";
+    }
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::openMapped<int>(path), std::runtime_error);
+
+    MyContainer<int> ints;
+    for (int i = 0; i < 100; ++i) {
+        ints.add(i);
+    }
+    io::save(ints, path);
+    CHECK_THROWS_AS(io::load<float>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::load<unsigned>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::openMapped<long>(path), std::runtime_error);
+
+    std::filesystem::resize_file(path, HeaderBytes + 50 * sizeof(int));
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::openMapped<int>(path), std::runtime_error);
+
+    // A damaged string length is reported as a bad file, not as a huge allocation
+    MyContainer<std::string> words;
+    words.add("alpha");
+    words.add("beta");
+    io::save(words, path);
+    for (uint64_t length : {uint64_t(1) << 62, ~uint64_t(0), uint64_t(100)}) {
+        {
+            std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(HeaderBytes);
+            f.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        }
+        CHECK_THROWS_AS(io::load<std::string>(path), std::runtime_error);
+    }
+    std::remove(path.c_str());
+}
+
+// Test that a stored permutation is adopted, remapped past dead slots and bound by its checksum
+TEST_CASE("Stored permutation serves the sorted orders without sorting") {
+    std::string path = tempPath("mycontainer_permutation.bin");
+    MyContainer<int> c;
+    c.deferRemoval(true, 1.0);
+    for (int i = 0; i < 1000; ++i) {
+        c.add((i * 613) % 1000);
+    }
+    c.remove(613);
+    io::save(c, path, true);
+
+    auto expected = collect(c.beginAscendingOrder(), c.endAscendingOrder());
+    MyContainer<int> loaded = io::load<int>(path);
+    CHECK(collect(loaded.beginAscendingOrder(), loaded.endAscendingOrder()) == expected);
+    auto mapped = io::openMapped<int>(path, true);
+    CHECK(collect(mapped.beginAscendingOrder(), mapped.endAscendingOrder()) == expected);
+    CHECK(collect(mapped.beginDescendingOrder(), mapped.endDescendingOrder()) ==
+          collect(c.beginDescendingOrder(), c.endDescendingOrder()));
+    CHECK(collect(mapped.beginSideCrossOrder(), mapped.endSideCrossOrder()) ==
+          collect(c.beginSideCrossOrder(), c.endSideCrossOrder()));
+    mapped.add(-1);
+    CHECK(*mapped.beginAscendingOrder() == -1);
+
+    // Swap the first two stored positions: the checksum no longer matches
+    uint64_t offset = (HeaderBytes + 999 * sizeof(int) + 7) / 8 * 8 + 16;
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t pos[2];
+        f.seekg(static_cast<std::streamoff>(offset));
+        f.read(reinterpret_cast<char*>(pos), sizeof(pos));
+        std::swap(pos[0], pos[1]);
+        f.seekp(static_cast<std::streamoff>(offset));
+        f.write(reinterpret_cast<const char*>(pos), sizeof(pos));
+    }
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::openMapped<int>(path, true), std::runtime_error);
+    auto trusted = io::openMapped<int>(path);  // Used as stored: proves no re-sort happens
+    auto it = trusted.beginAscendingOrder();
+    CHECK(*it == expected[1]);
+    CHECK(*++it == expected[0]);
+
+    // Positions out of range or repeated are rejected by load() and verify
+    auto setSecondPosition = [&](auto value) {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t pos[2];
+        f.seekg(static_cast<std::streamoff>(offset));
+        f.read(reinterpret_cast<char*>(pos), sizeof(pos));
+        pos[1] = value(pos[0]);
+        f.seekp(static_cast<std::streamoff>(offset));
+        f.write(reinterpret_cast<const char*>(pos), sizeof(pos));
+    };
+    setSecondPosition([](uint64_t) { return uint64_t(1000000); });
+    CHECK_THROWS_AS(io::openMapped<int>(path, true), std::runtime_error);
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+    setSecondPosition([](uint64_t) { return ~uint64_t(0); });
+    CHECK_THROWS_AS(io::openMapped<int>(path, true), std::runtime_error);
+    setSecondPosition([](uint64_t first) { return first; });
+    CHECK_THROWS_AS(io::openMapped<int>(path, true), std::runtime_error);
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+
+    // A permutation saved with other elements of the same length fails the O(1) binding
+    // check, even without verify
+    std::string otherPath = tempPath("mycontainer_permutation_other.bin");
+    MyContainer<int> other;
+    for (int i = 0; i < 999; ++i) {
+        other.add(i);
+    }
+    io::save(c, path, true);
+    io::save(other, otherPath, true);
+    {
+        std::ifstream donor(otherPath, std::ios::binary);
+        std::vector<char> section(16 + 999 * sizeof(uint64_t));
+        donor.seekg(static_cast<std::streamoff>(offset - 16));
+        donor.read(section.data(), static_cast<std::streamsize>(section.size()));
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(static_cast<std::streamoff>(offset - 16));
+        f.write(section.data(), static_cast<std::streamsize>(section.size()));
+    }
+    CHECK_THROWS_AS(io::openMapped<int>(path), std::runtime_error);
+    CHECK_THROWS_AS(io::load<int>(path), std::runtime_error);
+    std::remove(otherPath.c_str());
+
+    MyContainer<std::string> words;
+    for (const char* w : {"pear", "apple", "fig", "kiwi"}) {
+        words.add(w);
+    }
+    io::save(words, path, true);
+    MyContainer<std::string> wordsBack = io::load<std::string>(path);
+    CHECK(*wordsBack.beginAscendingOrder() == "apple");
+    CHECK(*wordsBack.beginDescendingOrder() == "pear");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,120 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify the vectorized find/count/removeAll kernels against the std:: algorithms.
+    - Verify MyContainer<T>::count(), contains() and remove() built on them.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+// Checks every kernel for every length up to 70 (covers vector bodies and tails)
+template<typename T>
+void checkKernels(const std::vector<T>& pool, T needle) {
+    for (size_t n = 0; n <= pool.size(); ++n) {
+        std::vector<T> v(pool.begin(), pool.begin() + static_cast<std::ptrdiff_t>(n));
+        size_t expectFind = static_cast<size_t>(std::find(v.begin(), v.end(), needle) - v.begin());
+        size_t expectCount = static_cast<size_t>(std::count(v.begin(), v.end(), needle));
+        std::vector<T> expectKept = v;
+        expectKept.erase(std::remove(expectKept.begin(), expectKept.end(), needle), expectKept.end());
+
+        CHECK(simd::find(v.data(), n, needle) == expectFind);
+        CHECK(simd::count(v.data(), n, needle) == expectCount);
+        size_t kept = simd::removeAll(v.data(), n, needle);
+        v.resize(kept);
+        // Bitwise comparison so kept NaNs compare equal
+        CHECK(v.size() == expectKept.size());
+        CHECK((v.empty() || std::memcmp(v.data(), expectKept.data(), v.size() * sizeof(T)) == 0));
+    }
+}
+
+} // namespace
+
+// Test 32-bit integer kernels against the scalar reference
+TEST_CASE("SIMD kernels match std algorithms for 32-bit integers") {
+    std::vector<int32_t> pool(70);
+    std::vector<uint32_t> upool(70);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i] = static_cast<int32_t>((i * 37) % 5) - 2;
+        upool[i] = static_cast<uint32_t>(pool[i]);
+    }
+    checkKernels<int32_t>(pool, 1);
+    checkKernels<int32_t>(pool, -2);
+    checkKernels<int32_t>(pool, 99);
+    checkKernels<uint32_t>(upool, 0xFFFFFFFEu);
+}
+
+// Test that other 4-byte integers (scalar path) keep unsigned semantics above 0x7FFFFFFF
+TEST_CASE("Kernels handle char32_t values above 0x7FFFFFFF") {
+    std::vector<char32_t> pool(70);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i] = static_cast<char32_t>(0x7FFFFFFEu + (i * 37) % 5);
+    }
+    checkKernels<char32_t>(pool, static_cast<char32_t>(0x80000001u));
+    checkKernels<char32_t>(pool, static_cast<char32_t>(0x7FFFFFFEu));
+    auto extremes = simd::minmax(pool.data(), pool.size());
+    CHECK(extremes.first == static_cast<char32_t>(0x7FFFFFFEu));
+    CHECK(extremes.second == static_cast<char32_t>(0x80000002u));
+
+    MyContainer<char32_t> c;
+    for (char32_t v : pool) {
+        c.add(v);
+    }
+    CHECK(c.count(static_cast<char32_t>(0x80000002u)) == 14);
+    c.remove(static_cast<char32_t>(0x80000002u));
+    CHECK(c.size() == 56);
+    CHECK(*c.beginDescendingOrder() == static_cast<char32_t>(0x80000001u));
+}
+
+// Test float kernels, including NaN and signed zero semantics of operator==
+TEST_CASE("SIMD kernels follow operator== for floats") {
+    std::vector<float> pool(70);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i] = static_cast<float>((i * 11) % 4) * 0.5f;
+    }
+    pool[3] = std::numeric_limits<float>::quiet_NaN();
+    pool[17] = -0.0f;
+    checkKernels<float>(pool, 0.5f);
+    checkKernels<float>(pool, 0.0f);
+
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    CHECK(simd::count(pool.data(), pool.size(), nan) == 0);
+}
+
+// Test the container members on arithmetic and non-arithmetic types
+TEST_CASE("count(), contains() and remove() use the kernels") {
+    MyContainer<int> c;
+    for (int i = 0; i < 100; ++i) {
+        c.add(i % 7);
+    }
+    CHECK(c.count(3) == 14);
+    CHECK(c.contains(6));
+    CHECK_FALSE(c.contains(7));
+    c.remove(3);
+    CHECK(c.size() == 86);
+    CHECK(c.count(3) == 0);
+    std::vector<int> rest(c.begin(), c.end());
+    CHECK(rest[0] == 0);
+    CHECK(rest[3] == 4);
+
+    MyContainer<std::string> s;
+    s.add("a");
+    s.add("b");
+    s.add("a");
+    CHECK(s.count("a") == 2);
+    CHECK_FALSE(s.contains("z"));
+    s.remove("a");
+    CHECK(s.size() == 1);
+}
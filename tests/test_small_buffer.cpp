@@ -0,0 +1,100 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify that iterators over containers of at most IndexSequence::InlineCapacity
+      elements keep their index sequence inline and perform no heap allocation.
+    - Verify that larger containers still switch to shared heap sequences.
+
+  Part of the test_alloc executable, whose counting operator new is in test_alloc.cpp
+  (see AllocCounter.hpp).
+*/
+
+#include "doctest.h"
+#include "AllocCounter.hpp"
+#include "MyContainer.hpp"
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+// Number of heap allocations made by fn() on the calling thread.
+template<typename Fn>
+size_t allocationsDuring(Fn fn) {
+    return alloctest::during(fn).allocations;
+}
+
+// Walks one traversal order and returns the sum of the visited elements.
+template<typename Iterator>
+int walk(Iterator it, Iterator end) {
+    int sum = 0;
+    for (; it != end; ++it) {
+        sum += *it;
+    }
+    return sum;
+}
+
+} // namespace
+
+// Test that all six orders over a small container allocate nothing
+TEST_CASE("Iterators over small containers do not allocate") {
+    MyContainer<int> c;
+    for (int v : {7, 15, 1, 2, 6}) {
+        c.add(v);
+    }
+
+    int sums[6] = {};
+    size_t count = allocationsDuring([&] {
+        sums[0] = walk(c.beginOrder(), c.endOrder());
+        sums[1] = walk(c.beginAscendingOrder(), c.endAscendingOrder());
+        sums[2] = walk(c.beginDescendingOrder(), c.endDescendingOrder());
+        sums[3] = walk(c.beginReverseOrder(), c.endReverseOrder());
+        sums[4] = walk(c.beginSideCrossOrder(), c.endSideCrossOrder());
+        sums[5] = walk(c.beginMiddleOutOrder(), c.endMiddleOutOrder());
+    });
+    CHECK(count == 0);
+    for (int s : sums) {
+        CHECK(s == 31);
+    }
+
+    std::vector<int> ascending;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        ascending.push_back(*it);
+    }
+    CHECK(ascending == std::vector<int>{1, 2, 6, 7, 15});
+}
+
+// Test the inline capacity boundary
+TEST_CASE("Inline index storage ends at InlineCapacity elements") {
+    MyContainer<int> c;
+    for (size_t i = 0; i < IndexSequence::InlineCapacity; ++i) {
+        c.add(static_cast<int>(IndexSequence::InlineCapacity - i));
+    }
+    int first = 0;
+    CHECK(allocationsDuring([&] { first = *c.beginSideCrossOrder(); }) == 0);
+    CHECK(first == 1);
+
+    c.add(100);  // Now past the inline capacity: the sequence comes from the scratch arena
+    ScratchArena::Stats before = ScratchArena::stats();
+    { auto it = c.beginOrder(); (void)it; }
+    ScratchArena::Stats after = ScratchArena::stats();
+    CHECK(after.allocations + after.reuses > before.allocations + before.reuses);
+    CHECK(*c.beginDescendingOrder() == 100);
+}
+
+// Test that small containers built from sorted runs also sort inline
+TEST_CASE("Small containers with sorted runs do not allocate") {
+    MyContainer<int> c;
+    c.addSortedRun({1, 4, 9});
+    c.addSortedRun({2, 3, 10});
+
+    std::vector<int> seen;
+    seen.reserve(6);
+    CHECK(allocationsDuring([&] {
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            seen.push_back(*it);
+        }
+    }) == 0);
+    CHECK(seen == std::vector<int>{1, 2, 3, 4, 9, 10});
+}
@@ -57,3 +57,51 @@ TEST_CASE("Iterator copy and assignment maintain independent state") {
     it2 = it3; // assignment operator
     CHECK(*it2 == *it3);
 }
+
+// Test that an iterator keeps reading its own buffer version after remove()
+// shrinks and shifts the container's elements
+TEST_CASE("Iterator snapshot is isolated from remove() shifting elements") {
+    MyContainer<int> c;
+    c.add(1);
+    c.add(2);
+    c.add(3);
+    c.add(4);
+
+    auto it = c.beginOrder();
+    c.remove(1);
+    c.remove(4);
+    CHECK(c.size() == 2);
+
+    // The old iterator still walks all four original elements, then reaches end
+    std::vector<int> seen;
+    for (int i = 0; i < 4; ++i) {
+        seen.push_back(*it);
+        ++it;
+    }
+    CHECK(seen == std::vector<int>({1, 2, 3, 4}));
+    CHECK_THROWS_AS(*it, std::runtime_error);
+}
+
+// Test that the element buffer is copied only while a snapshot is outstanding
+TEST_CASE("Copy-on-write buffer is shared by snapshots and detached on mutation") {
+    MyContainer<int> c;
+    c.add(1);
+    c.add(2);
+
+    auto before = c.snapshot();
+    c.add(3);  // snapshot outstanding: buffer is copied
+    CHECK(before->size() == 2);
+    CHECK(c.snapshot() != before);
+
+    before.reset();
+    auto* buffer = c.snapshot().get();
+    c.add(4);  // no snapshot outstanding: mutated in place
+    CHECK(c.snapshot().get() == buffer);
+
+    // Container copies share the buffer until one of them is mutated
+    MyContainer<int> copy = c;
+    CHECK(copy.snapshot() == c.snapshot());
+    copy.remove(1);
+    CHECK(c.size() == 4);
+    CHECK(copy.size() == 3);
+}
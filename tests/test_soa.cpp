@@ -0,0 +1,104 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify SoAContainer: column storage, record reconstruction, the six traversal
+      orders (keyed on the first member), field projections and remove().
+*/
+
+#include "doctest.h"
+#include "SoAContainer.hpp"
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+struct Trade {
+    double price = 0;
+    long id = 0;
+    std::string venue;
+};
+
+using Trades = SoAContainer<Trade, &Trade::price, &Trade::id, &Trade::venue>;
+
+Trades sampleTrades() {
+    Trades t;
+    t.add({101.5, 1, "X"});
+    t.add({99.0, 2, "Y"});
+    t.add({105.25, 3, "X"});
+    t.add({99.0, 4, "Z"});
+    t.add({100.0, 5, "Y"});
+    return t;
+}
+
+template<typename View>
+std::vector<long> ids(const View& view) {
+    std::vector<long> out;
+    for (const Trade& trade : view) {
+        out.push_back(trade.id);
+    }
+    return out;
+}
+
+} // namespace
+
+// Test that each member lives in its own contiguous column
+TEST_CASE("SoAContainer stores members column by column") {
+    Trades t = sampleTrades();
+    CHECK(t.size() == 5);
+    CHECK(t.column<&Trade::price>() == std::vector<double>{101.5, 99.0, 105.25, 99.0, 100.0});
+    CHECK(t.column<&Trade::id>() == std::vector<long>{1, 2, 3, 4, 5});
+    CHECK(t.at(2).venue == "X");
+    CHECK(t.at(2).price == 105.25);
+    CHECK_THROWS_AS(t.at(5), std::runtime_error);
+}
+
+// Test the six orders over whole records (ties on the key keep insertion order)
+TEST_CASE("SoAContainer record traversals follow the key column") {
+    Trades t = sampleTrades();
+    CHECK(ids(t.records(Traversal::Order)) == std::vector<long>{1, 2, 3, 4, 5});
+    CHECK(ids(t.records(Traversal::Ascending)) == std::vector<long>{2, 4, 5, 1, 3});
+    CHECK(ids(t.records(Traversal::Descending)) == std::vector<long>{3, 1, 5, 4, 2});
+    CHECK(ids(t.records(Traversal::Reverse)) == std::vector<long>{5, 4, 3, 2, 1});
+    CHECK(ids(t.records(Traversal::SideCross)) == std::vector<long>{2, 3, 4, 1, 5});
+    CHECK(ids(t.records(Traversal::MiddleOut)) == std::vector<long>{3, 2, 4, 1, 5});
+}
+
+// Test single-column projections
+TEST_CASE("SoAContainer field projections visit one column") {
+    Trades t = sampleTrades();
+    std::vector<std::string> venues;
+    for (const std::string& v : t.field<&Trade::venue>(Traversal::Ascending)) {
+        venues.push_back(v);
+    }
+    CHECK(venues == std::vector<std::string>{"Y", "Z", "Y", "X", "X"});
+
+    double total = 0;
+    for (double p : t.field<&Trade::price>(Traversal::Order)) {
+        total += p;
+    }
+    CHECK(total == doctest::Approx(504.75));
+    CHECK(t.field<&Trade::id>(Traversal::MiddleOut).size() == 5);
+}
+
+// Test removal and cache invalidation
+TEST_CASE("SoAContainer remove drops matching records from every column") {
+    Trades t = sampleTrades();
+    CHECK(*t.field<&Trade::id>(Traversal::Ascending).begin() == 2);
+    t.remove({99.0, 2, "Y"});
+    CHECK(t.size() == 4);
+    CHECK(t.column<&Trade::venue>() == std::vector<std::string>{"X", "X", "Z", "Y"});
+    CHECK(*t.field<&Trade::id>(Traversal::Ascending).begin() == 4);
+    CHECK_THROWS_AS(t.remove({99.0, 2, "Y"}), std::runtime_error);
+
+    for (long i = 0; i < 40; ++i) {
+        t.add({static_cast<double>(i % 7), 100 + i, "W"});
+    }
+    double previous = -1;
+    for (double p : t.field<&Trade::price>(Traversal::Ascending)) {
+        CHECK(previous <= p);
+        previous = p;
+    }
+}
@@ -0,0 +1,100 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify MyContainer<T>::addSortedRun() and the k-way merged sorted permutation.
+    - Confirm run boundaries survive remove() and mixing with plain add().
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+template<typename T>
+std::vector<T> ascending(const MyContainer<T>& c) {
+    std::vector<T> seen;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        seen.push_back(*it);
+    }
+    return seen;
+}
+
+} // namespace
+
+// Test merging sorted runs mixed with unsorted plain adds
+TEST_CASE("Sorted runs and plain adds merge into ascending order") {
+    MyContainer<int> c;
+    c.add(9);
+    c.add(4);
+    c.addSortedRun({1, 5, 8});
+    c.addSortedRun({2, 3, 10});
+    c.add(7);
+    c.add(0);
+
+    CHECK(c.size() == 10);
+    CHECK(ascending(c) == std::vector<int>({0, 1, 2, 3, 4, 5, 7, 8, 9, 10}));
+
+    // Insertion order is untouched
+    std::vector<int> inserted(c.begin(), c.end());
+    CHECK(inserted == std::vector<int>({9, 4, 1, 5, 8, 2, 3, 10, 7, 0}));
+
+    // Descending and side-cross orders use the same permutation
+    CHECK(*c.beginDescendingOrder() == 10);
+    auto sc = c.beginSideCrossOrder();
+    CHECK(*sc == 0);
+    ++sc;
+    CHECK(*sc == 10);
+
+    // Unsorted runs are rejected without modifying the container
+    CHECK_THROWS_AS(c.addSortedRun({3, 2}), std::runtime_error);
+    CHECK(c.size() == 10);
+}
+
+// Test that remove() keeps run boundaries consistent
+TEST_CASE("remove() keeps sorted runs consistent") {
+    MyContainer<int> c;
+    c.addSortedRun({1, 2, 2, 6});
+    c.addSortedRun({2, 2});
+    c.addSortedRun({0, 2, 5});
+    c.remove(2);
+    CHECK(ascending(c) == std::vector<int>({0, 1, 5, 6}));
+    c.addSortedRun({3, 4});
+    CHECK(ascending(c) == std::vector<int>({0, 1, 3, 4, 5, 6}));
+}
+
+// Test the parallel merge path on many large runs against a plain sort
+TEST_CASE("Parallel multiway merge matches std::sort on large inputs") {
+    MyContainer<int> c;
+    std::vector<int> all;
+    unsigned seed = 12345;
+    for (int r = 0; r < 9; ++r) {
+        std::vector<int> run(5000 + 37 * r);
+        for (int& x : run) {
+            seed = seed * 1103515245u + 12345u;
+            x = static_cast<int>((seed >> 8) % 1000);  // Many duplicates
+        }
+        std::sort(run.begin(), run.end());
+        c.addSortedRun(run);
+        all.insert(all.end(), run.begin(), run.end());
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(ascending(c) == all);
+}
+
+// Test the loser tree directly, including empty runs and ties between runs
+TEST_CASE("loserTreeMerge merges index runs stably") {
+    std::vector<int> values = {1, 4, 4, 2, 4, 3};
+    std::vector<size_t> a = {0, 1}, b = {}, c = {3, 2, 4}, d = {5};
+    std::vector<parallel::IndexRun> runs = {
+        {a.data(), a.data() + a.size()}, {b.data(), b.data()},
+        {c.data(), c.data() + 1}, {c.data() + 1, c.data() + 3}, {d.data(), d.data() + 1}};
+    std::vector<size_t> out(6);
+    parallel::loserTreeMerge(runs, out.data(),
+                             [&](size_t x, size_t y) { return values[x] < values[y]; });
+    CHECK(out == std::vector<size_t>({0, 3, 5, 1, 2, 4}));
+}
@@ -0,0 +1,185 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify the small-size sorting network against std::stable_sort for every size
+      it handles and for narrow, wide, signed, unsigned and floating-point keys.
+    - Verify the leaf-and-merge sort built on the network for longer ranges, and that
+      NaN keys of either sign sort after +infinity.
+    - Confirm that containers in the network's size range produce the right sorted orders.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+// Keys drawn from 9 values (duplicates); added step by step so no product overflows K.
+template<typename K>
+std::vector<K> makeKeys(size_t n, K lo, K step, unsigned& seed) {
+    std::vector<K> keys(n);
+    for (auto& k : keys) {
+        seed = seed * 1103515245u + 12345u;
+        k = lo;
+        for (unsigned r = (seed >> 16) % 9; r > 0; --r) {
+            k = static_cast<K>(k + step);
+        }
+    }
+    return keys;
+}
+
+template<typename K>
+std::vector<size_t> stableOrder(const std::vector<K>& keys) {
+    std::vector<size_t> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), size_t(0));
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+    return expected;
+}
+
+template<typename K>
+void checkLeaves(K lo, K step) {
+    unsigned seed = 11;
+    for (size_t n : {size_t(65), size_t(100), size_t(128), size_t(129), size_t(1000), size_t(4099)}) {
+        std::vector<K> keys = makeKeys(n, lo, step, seed);
+        std::vector<size_t> actual(n);
+        std::vector<size_t> scratch(n);
+        std::iota(actual.begin(), actual.end(), size_t(0));
+        simd::sortIndicesLeaves(keys.data(), actual.data(), actual.data() + n, scratch.data());
+        CHECK(actual == stableOrder(keys));
+    }
+}
+
+template<typename K>
+void checkNetwork(K lo, K step) {
+    unsigned seed = 7;
+    for (size_t n = 2; n <= simd::SmallSortMax; ++n) {
+        std::vector<K> keys = makeKeys(n, lo, step, seed);
+        std::vector<size_t> actual(n);
+        std::iota(actual.begin(), actual.end(), size_t(0));
+        simd::sortIndicesSmall(keys.data(), actual.data(), actual.data() + n);
+        CHECK(actual == stableOrder(keys));
+    }
+}
+
+} // namespace
+
+// Test the network for every supported key width and signedness
+TEST_CASE("Sorting network matches std::stable_sort for sizes 2..64") {
+    checkNetwork<int8_t>(-4, 1);
+    checkNetwork<uint16_t>(0, 1000);
+    checkNetwork<int32_t>(-2000000000, 400000000);
+    checkNetwork<uint32_t>(0, 500000000u);
+    checkNetwork<float>(-2.0f, 0.75f);
+    checkNetwork<int64_t>(-(int64_t(1) << 40), int64_t(1) << 38);
+    checkNetwork<double>(-1e300, 2.5e299);
+}
+
+// Test that containers in the network's size range keep correct orders
+TEST_CASE("Small containers sort through the network") {
+    MyContainer<float> c;
+    std::vector<float> values;
+    for (int i = 0; i < 60; ++i) {
+        values.push_back(static_cast<float>((i * 37) % 23) - 11.5f);  // Duplicates, negatives
+    }
+    for (float v : values) {
+        c.add(v);
+    }
+    CHECK(simd::useSortingNetwork<float>(values.size()) == (std::string(simd::activeIsa()) == "avx2"));
+
+    std::sort(values.begin(), values.end());
+    std::vector<float> seen;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        seen.push_back(*it);
+    }
+    CHECK(seen == values);
+    CHECK(*c.beginDescendingOrder() == values.back());
+}
+
+// Test the network as the leaf sort of longer ranges
+TEST_CASE("Leaf-and-merge sort matches std::stable_sort past 64 indices") {
+    checkLeaves<int8_t>(-4, 1);
+    checkLeaves<uint16_t>(0, 1000);
+    checkLeaves<int32_t>(-2000000000, 400000000);
+    checkLeaves<uint32_t>(0, 500000000u);
+    checkLeaves<float>(-2.0f, 0.75f);
+    CHECK(simd::useNetworkLeaves<int>(1000) == (std::string(simd::activeIsa()) == "avx2"));
+    CHECK_FALSE(simd::useNetworkLeaves<double>(1000));
+}
+
+// Test that NaN keys of either sign sort after +infinity, in both sorts
+TEST_CASE("NaN keys sort last") {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> keys;
+    for (size_t i = 0; i < 130; ++i) {
+        float pattern[] = {std::copysign(nan, -1.0f), inf, -inf, 1.5f, -2.0f, std::copysign(nan, 1.0f), 0.0f};
+        keys.push_back(pattern[i % 7]);
+    }
+    auto checkOrder = [&](const std::vector<size_t>& order) {
+        size_t nans = 0;
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (std::isnan(keys[order[i]])) {
+                ++nans;
+            } else {
+                CHECK(nans == 0);  // No number after a NaN
+                CHECK((i == 0 || keys[order[i - 1]] <= keys[order[i]]));
+            }
+        }
+        CHECK(keys[order[order.size() - nans - 1]] == inf);
+    };
+
+    std::vector<size_t> small(64);
+    std::iota(small.begin(), small.end(), size_t(0));
+    simd::sortIndicesSmall(keys.data(), small.data(), small.data() + small.size());
+    checkOrder(small);
+
+    std::vector<size_t> large(keys.size());
+    std::vector<size_t> scratch(keys.size());
+    std::iota(large.begin(), large.end(), size_t(0));
+    simd::sortIndicesLeaves(keys.data(), large.data(), large.data() + large.size(), scratch.data());
+    checkOrder(large);
+}
+
+// Test that larger containers, with and without sorted runs, sort through the leaves
+TEST_CASE("Larger containers sort through network leaves") {
+    MyContainer<int> c;
+    std::vector<int> values;
+    for (int i = 0; i < 3000; ++i) {
+        values.push_back((i * 7919) % 1009 - 500);
+    }
+    for (int v : values) {
+        c.add(v);
+    }
+    std::vector<int> run = {-1000, 0, 1000};
+    MyContainer<int> withRuns;
+    withRuns.addSortedRun(run);
+    for (int v : values) {
+        withRuns.add(v);
+    }
+
+    std::sort(values.begin(), values.end());
+    std::vector<int> seen;
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+        seen.push_back(*it);
+    }
+    CHECK(seen == values);
+
+    values.insert(values.begin(), -1000);
+    values.insert(std::upper_bound(values.begin(), values.end(), 0), 0);
+    values.push_back(1000);
+    seen.clear();
+    for (auto it = withRuns.beginAscendingOrder(); it != withRuns.endAscendingOrder(); ++it) {
+        seen.push_back(*it);
+    }
+    CHECK(seen == values);
+}
@@ -0,0 +1,110 @@
+// eitan.derdiger@gmail.com
+
+// Built as its own executable with -DMYCONTAINER_STATS (see the Makefile): the counters
+// change MyContainer's layout, so they cannot share a binary with the other tests.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <string>
+
+/*
+  Purpose:
+    - Verify the MYCONTAINER_STATS counters: sequences per order and their heap bytes,
+      permutation builds versus cache hits, removes and shifted elements, compactions.
+    - Verify the JSON dump and resetStats().
+*/
+
+using namespace container;
+
+#ifndef MYCONTAINER_STATS
+#error "test_stats.cpp must be built with -DMYCONTAINER_STATS"
+#endif
+
+// Test that iterator constructions and permutation builds are counted per order
+TEST_CASE("Stats count sequences and permutation builds") {
+    MyContainer<int> c;
+    for (int i = 0; i < 100; ++i) {
+        c.add((i * 37) % 101);
+    }
+    CHECK(c.stats().enabled);
+
+    for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {}
+    ContainerStats s = c.stats();
+    CHECK(s.sequencesOf(Traversal::Ascending) == 1);  // The 101 end() calls build nothing
+    CHECK(s.permutationBuilds == 1);
+    CHECK(s.permutationCacheHits == 0);
+    CHECK(s.sequenceBytes == 0);  // AscendingOrder shares the cached permutation
+
+    auto end = c.endDescendingOrder();
+    for (auto it = c.beginDescendingOrder(); it != end; ++it) {}
+    s = c.stats();
+    CHECK(s.sequencesOf(Traversal::Descending) == 1);
+    CHECK(s.permutationBuilds == 1);
+    CHECK(s.permutationCacheHits == 1);
+    CHECK(s.sequenceBytes == 100 * sizeof(size_t));
+
+    c.beginOrder();
+    c.beginMiddleOutOrder();
+    c.beginSideCrossOrder();
+    c.beginReverseOrder();
+    s = c.stats();
+    for (Traversal t : {Traversal::Order, Traversal::MiddleOut, Traversal::SideCross, Traversal::Reverse}) {
+        CHECK(s.sequencesOf(t) == 1);
+    }
+
+    // Small containers sort into the inline sequence instead of the cache
+    MyContainer<int> small;
+    small.add(3);
+    small.add(1);
+    small.beginAscendingOrder();
+    CHECK(small.stats().permutationBuilds == 1);
+    CHECK(small.stats().sequenceBytes == 0);
+
+    // Adding invalidates the permutation, so the next sorted order sorts again
+    c.add(7);
+    c.beginAscendingOrder();
+    CHECK(c.stats().permutationBuilds == 2);
+}
+
+// Test removes, shifted elements and compactions
+TEST_CASE("Stats count removal work") {
+    MyContainer<int> c;
+    for (int v : {1, 2, 3, 2, 5, 6}) {
+        c.add(v);
+    }
+    c.remove(2);  // The first 2 is at slot 1; 3, 5 and 6 move
+    ContainerStats s = c.stats();
+    CHECK(s.removes == 1);
+    CHECK(s.elementsShifted == 3);
+
+    c.remove(6);  // Last element: nothing moves
+    CHECK(c.stats().elementsShifted == 3);
+
+    c.deferRemoval(true, 1.0);
+    c.remove(1);  // Only marked dead
+    CHECK(c.stats().removes == 3);
+    CHECK(c.stats().elementsShifted == 3);
+    c.compact();  // 3 and 5 move down over slot 0
+    CHECK(c.stats().compactions == 1);
+    CHECK(c.stats().elementsShifted == 5);
+
+    // A copy starts counting afresh
+    MyContainer<int> copy(c);
+    CHECK(copy.stats().removes == 0);
+}
+
+// Test the JSON dump and reset
+TEST_CASE("Stats JSON dump and reset") {
+    MyContainer<int> c;
+    c.add(1);
+    c.beginOrder();
+    std::string json = c.stats().toJson();
+    CHECK(json.find("\"enabled\": true") != std::string::npos);
+    CHECK(json.find("\"sequences\": {\"order\": 1, \"ascending\": 0") != std::string::npos);
+    CHECK(json.find("\"permutationBuilds\": 0") != std::string::npos);
+    CHECK(json.front() == '{');
+    CHECK(json.back() == '}');
+
+    c.resetStats();
+    CHECK(c.stats().sequencesOf(Traversal::Order) == 0);
+}
@@ -0,0 +1,180 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify deferred removal: remove() marks dead slots, every order and query skips
+      them, and compaction (explicit or past the ratio) leaves the same contents as
+      eager removal, including sorted-run boundaries and the segmented policy.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include <sstream>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+template<typename Iterator>
+std::vector<int> collect(Iterator it, Iterator end) {
+    std::vector<int> out;
+    for (; it != end; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+template<typename A, typename B>
+void checkSameOrders(const A& a, const B& b) {
+    CHECK(a.size() == b.size());
+    CHECK(collect(a.beginOrder(), a.endOrder()) == collect(b.beginOrder(), b.endOrder()));
+    CHECK(collect(a.beginAscendingOrder(), a.endAscendingOrder()) ==
+          collect(b.beginAscendingOrder(), b.endAscendingOrder()));
+    CHECK(collect(a.beginDescendingOrder(), a.endDescendingOrder()) ==
+          collect(b.beginDescendingOrder(), b.endDescendingOrder()));
+    CHECK(collect(a.beginReverseOrder(), a.endReverseOrder()) ==
+          collect(b.beginReverseOrder(), b.endReverseOrder()));
+    CHECK(collect(a.beginSideCrossOrder(), a.endSideCrossOrder()) ==
+          collect(b.beginSideCrossOrder(), b.endSideCrossOrder()));
+    CHECK(collect(a.beginMiddleOutOrder(), a.endMiddleOutOrder()) ==
+          collect(b.beginMiddleOutOrder(), b.endMiddleOutOrder()));
+}
+
+} // namespace
+
+// Test that dead slots are invisible to every order and query
+TEST_CASE("Deferred removal skips dead slots everywhere") {
+    MyContainer<int> lazy, eager;
+    lazy.deferRemoval(true, 0.9);
+    for (int i = 0; i < 500; ++i) {
+        int v = (i * 37) % 101;
+        lazy.add(v);
+        eager.add(v);
+    }
+    for (int v : {0, 50, 100, 7}) {
+        lazy.remove(v);
+        eager.remove(v);
+    }
+    CHECK(lazy.deadSlots() > 0);
+    CHECK(lazy.snapshot()->size() == 500);
+    checkSameOrders(lazy, eager);
+
+    CHECK_FALSE(lazy.contains(50));
+    CHECK(lazy.count(50) == 0);
+    CHECK(lazy.count(51) == eager.count(51));
+    CHECK(lazy.sum() == eager.sum());
+    CHECK(lazy.minmax() == std::make_pair(1, 99));
+    CHECK_THROWS_AS(lazy.remove(50), std::runtime_error);
+
+    std::ostringstream a, b;
+    a << lazy;
+    b << eager;
+    CHECK(a.str() == b.str());
+
+    lazy.compact();
+    CHECK(lazy.deadSlots() == 0);
+    CHECK(lazy.snapshot()->size() == eager.size());
+    checkSameOrders(lazy, eager);
+}
+
+// Test the index-only orders around a dead slot at the front, middle and back
+TEST_CASE("Deferred removal keeps insertion, reverse and middle-out positions") {
+    for (int n = 2; n <= 70; ++n) {
+        for (int gone : {0, n / 2, n - 1}) {
+            MyContainer<int> lazy, eager;
+            lazy.deferRemoval(true, 1.0);
+            for (int i = 0; i < n; ++i) {
+                lazy.add(i);
+                eager.add(i);
+            }
+            lazy.remove(gone);
+            eager.remove(gone);
+            CHECK(collect(lazy.beginOrder(), lazy.endOrder()) == collect(eager.beginOrder(), eager.endOrder()));
+            CHECK(collect(lazy.beginReverseOrder(), lazy.endReverseOrder()) ==
+                  collect(eager.beginReverseOrder(), eager.endReverseOrder()));
+            CHECK(collect(lazy.beginMiddleOutOrder(), lazy.endMiddleOutOrder()) ==
+                  collect(eager.beginMiddleOutOrder(), eager.endMiddleOutOrder()));
+        }
+    }
+}
+
+// Test the automatic compaction threshold and disabling the mode
+TEST_CASE("Deferred removal compacts past the ratio") {
+    MyContainer<int> c;
+    c.deferRemoval(true, 0.25);
+    for (int i = 0; i < 100; ++i) {
+        c.add(i % 10);
+    }
+    c.remove(1);
+    c.remove(2);
+    CHECK(c.deadSlots() == 20);
+    c.remove(3);  // 30 of 100 slots dead
+    CHECK(c.deadSlots() == 0);
+    CHECK(c.snapshot()->size() == 70);
+
+    c.remove(4);
+    CHECK(c.deadSlots() == 10);
+    c.deferRemoval(false);
+    CHECK(c.deadSlots() == 0);
+    CHECK(c.size() == 60);
+    c.remove(5);
+    CHECK(c.snapshot()->size() == 50);
+
+    CHECK_THROWS_AS(c.deferRemoval(true, 0.0), std::runtime_error);
+    CHECK_THROWS_AS(c.deferRemoval(true, 1.5), std::runtime_error);
+}
+
+// Test small (inline) sequences, extrema tracking, copies and moves
+TEST_CASE("Deferred removal with small containers, extrema and copies") {
+    MyContainer<int> c;
+    c.deferRemoval(true, 1.0);
+    c.trackExtrema(true);
+    for (int v : {5, 1, 9, 3, 9, 7}) {
+        c.add(v);
+    }
+    c.remove(9);
+    c.remove(1);
+    CHECK(collect(c.beginAscendingOrder(), c.endAscendingOrder()) == std::vector<int>{3, 5, 7});
+    CHECK(collect(c.beginMiddleOutOrder(), c.endMiddleOutOrder()) == std::vector<int>{3, 5, 7});
+    CHECK(c.min() == 3);
+    CHECK(c.max() == 7);
+
+    MyContainer<int> copy = c;
+    CHECK(copy.size() == 3);
+    CHECK(collect(copy.beginOrder(), copy.endOrder()) == std::vector<int>{5, 3, 7});
+
+    MyContainer<int> moved = std::move(copy);
+    CHECK(moved.size() == 3);
+    CHECK(moved.deadSlots() == 3);
+    CHECK(copy.size() == 0);  // NOLINT(bugprone-use-after-move)
+}
+
+// Test run boundaries across compaction and the segmented policy
+TEST_CASE("Deferred removal keeps sorted runs and segmented storage consistent") {
+    MyContainer<int, std::allocator<int>, SegmentedStorage> seg;
+    MyContainer<int> vec;
+    seg.deferRemoval(true, 0.5);
+    std::vector<int> run;
+    for (int i = 0; i < 6000; ++i) {
+        run.push_back(i * 2);
+    }
+    for (int i = 0; i < 3000; ++i) {
+        int v = (i * 7919) % 4001;
+        seg.add(v);
+        vec.add(v);
+    }
+    seg.addSortedRun(run);
+    vec.addSortedRun(run);
+    for (int v : {2, 4000, 10, 3918}) {
+        seg.remove(v);
+        vec.remove(v);
+    }
+    checkSameOrders(seg, vec);
+    seg.compact();
+    checkSameOrders(seg, vec);
+    seg.add(-1);
+    vec.add(-1);
+    CHECK(*seg.beginAscendingOrder() == -1);
+    checkSameOrders(seg, vec);
+}
@@ -0,0 +1,122 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify that VersionedContainer<T> readers see consistent, immutable versions
+      while a writer publishes new ones.
+    - Confirm that old versions are reclaimed once no reader holds them.
+    - Check that snapshots pin a prefix across log chunk boundaries and copy it only
+      when mutated.
+*/
+
+#include "doctest.h"
+#include "VersionedContainer.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace container;
+
+// Test that a held snapshot is unaffected by later writes and is released afterwards
+TEST_CASE("VersionedContainer snapshots are immutable and reclaimed") {
+    VersionedContainer<int> vc;
+    vc.add(3);
+    vc.add(1);
+    CHECK(vc.version() == 2);
+
+    auto v = vc.snapshot();
+    std::weak_ptr<const VersionedContainer<int>::Snapshot> watch = v;
+    vc.add(2);
+    vc.remove(3);
+    CHECK(v->size() == 2);
+    CHECK(vc.size() == 2);
+
+    std::vector<int> seen;
+    for (auto it = v->beginAscendingOrder(); it != v->endAscendingOrder(); ++it) {
+        seen.push_back(*it);
+    }
+    CHECK(seen == std::vector<int>({1, 3}));
+
+    v.reset();
+    CHECK(watch.expired());
+
+    // Readers of one version share the same prebuilt snapshot
+    CHECK(vc.snapshot() == vc.snapshot());
+
+    // A failed removal publishes nothing
+    CHECK_THROWS_AS(vc.remove(99), std::runtime_error);
+    CHECK(vc.version() == 4);
+}
+
+// Test concurrent readers traversing while a single writer appends
+TEST_CASE("VersionedContainer readers traverse while a writer publishes") {
+    VersionedContainer<int> vc;
+    constexpr int total = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<int> badVersions{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                auto v = vc.snapshot();
+                // Every version holds exactly 0..size-1 in insertion order
+                int expected = 0;
+                for (int x : *v) {
+                    if (x != expected++) badVersions.fetch_add(1);
+                }
+                auto it = v->beginDescendingOrder();
+                if (v->size() > 0 && *it != static_cast<int>(v->size()) - 1) {
+                    badVersions.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < total; ++i) {
+        vc.add(i);
+    }
+    done.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    CHECK(badVersions.load() == 0);
+    CHECK(vc.size() == static_cast<size_t>(total));
+}
+
+// Test that snapshots pin a prefix while the writer appends across chunk boundaries
+TEST_CASE("VersionedContainer snapshots pin a prefix of the log") {
+    VersionedContainer<int> vc;
+    constexpr int first = 5000;  // Past the first 4096-element chunk
+    for (int i = 0; i < first; ++i) {
+        vc.add(first - i);
+    }
+    auto v = vc.snapshot();
+    for (int i = 0; i < 20000; ++i) {
+        vc.add(-i);
+    }
+    CHECK(vc.size() == static_cast<size_t>(first + 20000));
+    CHECK(v->size() == static_cast<size_t>(first));
+    CHECK(*v->beginAscendingOrder() == 1);
+    CHECK(*v->beginDescendingOrder() == first);
+    long sum = 0;
+    for (int x : *v) {
+        sum += x;
+    }
+    CHECK(sum == static_cast<long>(first) * (first + 1) / 2);
+
+    // A copy of a snapshot is an ordinary container: mutating it copies the prefix
+    VersionedContainer<int>::Snapshot copy = *v;
+    copy.add(0);
+    copy.remove(first);
+    CHECK(copy.size() == static_cast<size_t>(first));
+    CHECK(*copy.beginAscendingOrder() == 0);
+    CHECK(v->size() == static_cast<size_t>(first));
+    CHECK(*v->beginDescendingOrder() == first);
+
+    // remove() starts a new log; the held snapshot keeps reading the old one
+    vc.remove(1);
+    CHECK(vc.size() == static_cast<size_t>(first + 20000 - 1));
+    CHECK(*v->beginAscendingOrder() == 1);
+}
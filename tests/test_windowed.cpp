@@ -0,0 +1,94 @@
+// eitan.derdiger@gmail.com
+
+/*
+  Purpose:
+    - Verify WindowedContainer: after every add(), all six orders over the window match
+      a MyContainer built from the same last-N values.
+    - Verify eviction, min()/max() and the error cases.
+*/
+
+#include "doctest.h"
+#include "MyContainer.hpp"
+#include "WindowedContainer.hpp"
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+template<typename Iterator>
+auto collect(Iterator it, Iterator end) {
+    std::vector<std::decay_t<decltype(*it)>> out;
+    for (; it != end; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+} // namespace
+
+// Test every order against MyContainer while the window fills and slides
+TEST_CASE("WindowedContainer orders match MyContainer over the window") {
+    for (size_t window : {1, 2, 5, 8, 33}) {
+        WindowedContainer<int> w(window);
+        std::deque<int> last;
+        for (int i = 0; i < 120; ++i) {
+            int v = static_cast<int>((i * 37 + 11) % 23) - 10;  // Many duplicates
+            w.add(v);
+            last.push_back(v);
+            if (last.size() > window) {
+                last.pop_front();
+            }
+
+            MyContainer<int> ref;
+            for (int x : last) {
+                ref.add(x);
+            }
+            REQUIRE(w.size() == last.size());
+            CHECK(collect(w.beginOrder(), w.endOrder()) == collect(ref.beginOrder(), ref.endOrder()));
+            CHECK(collect(w.beginAscendingOrder(), w.endAscendingOrder()) ==
+                  collect(ref.beginAscendingOrder(), ref.endAscendingOrder()));
+            CHECK(collect(w.beginDescendingOrder(), w.endDescendingOrder()) ==
+                  collect(ref.beginDescendingOrder(), ref.endDescendingOrder()));
+            CHECK(collect(w.beginReverseOrder(), w.endReverseOrder()) ==
+                  collect(ref.beginReverseOrder(), ref.endReverseOrder()));
+            CHECK(collect(w.beginSideCrossOrder(), w.endSideCrossOrder()) ==
+                  collect(ref.beginSideCrossOrder(), ref.endSideCrossOrder()));
+            CHECK(collect(w.beginMiddleOutOrder(), w.endMiddleOutOrder()) ==
+                  collect(ref.beginMiddleOutOrder(), ref.endMiddleOutOrder()));
+        }
+    }
+}
+
+// Test eviction of the oldest value and the O(1) extremes
+TEST_CASE("WindowedContainer evicts the oldest value") {
+    WindowedContainer<int> w(3);
+    w.add(100);
+    w.add(5);
+    w.add(50);
+    CHECK(w.full());
+    CHECK(w.max() == 100);
+    w.add(7);  // Evicts 100
+    CHECK(w.size() == 3);
+    CHECK(w.max() == 50);
+    CHECK(w.min() == 5);
+    CHECK(w.ascending() == std::vector<int>{5, 7, 50});
+    CHECK(collect(w.begin(), w.end()) == std::vector<int>{5, 50, 7});
+}
+
+// Test invalid windows and iterator misuse
+TEST_CASE("WindowedContainer errors") {
+    CHECK_THROWS_AS(WindowedContainer<int>(0), std::runtime_error);
+    WindowedContainer<int> w(4);
+    CHECK_THROWS_AS(w.min(), std::runtime_error);
+    CHECK_THROWS_AS(w.max(), std::runtime_error);
+    CHECK_THROWS_AS(*w.beginOrder(), std::runtime_error);
+    w.add(1);
+    auto it = w.beginMiddleOutOrder();
+    CHECK(*it == 1);
+    ++it;
+    CHECK(it == w.endMiddleOutOrder());
+    CHECK_THROWS_AS(++it, std::runtime_error);
+}